@@ -11,6 +11,7 @@
 #include <filesystem>
 #include <format>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace phosphor
@@ -76,57 +77,105 @@ auto Activation::requestedActivation(RequestedActivations value)
             // information may have been found on D-Bus, or a new PSU may have
             // been plugged in.
             shouldActivateAgain = true;
+            targetPsus.reset();
         }
     }
     return SoftwareActivation::requestedActivation(value);
 }
 
-auto Activation::extendedVersion(std::string value) -> std::string
+void Activation::setManifest(const Manifest& manifest)
 {
-    auto info = Version::getExtVersionInfo(value);
-    manufacturer = info["manufacturer"];
-    model = info["model"];
+    manufacturer = manifest.manufacturer;
+    model = manifest.model;
+    extendedVersion(manifest.extendedVersion);
+}
 
-    return ExtendedVersion::extendedVersion(value);
+auto Activation::path(std::string value) -> std::string
+{
+    auto oldPath = path();
+    auto newPath = FilePath::path(std::move(value));
+    if (newPath != oldPath)
+    {
+        activationListener->onPathChanged(handle, oldPath, newPath);
+    }
+    return newPath;
 }
 
-void Activation::unitStateChange(sdbusplus::message_t& msg)
+auto Activation::associations(AssociationList value) -> AssociationList
 {
-    uint32_t newStateID{};
-    sdbusplus::object_path newStateObjPath;
-    std::string newStateUnit{};
-    std::string newStateResult{};
+    if (value != associations())
+    {
+        associationStore = AssociationStore(value);
+        ActivationInherit::associations(std::move(value), true);
+        associationsEmitter.schedule();
+    }
+    return associations();
+}
 
-    try
+void Activation::addPsuAssociation(const std::string& psuInventoryPath)
+{
+    if (associationStore.add(ACTIVATION_FWD_ASSOCIATION,
+                             ACTIVATION_REV_ASSOCIATION, psuInventoryPath))
     {
-        // Read the msg and populate each variable
-        msg.read(newStateID, newStateObjPath, newStateUnit, newStateResult);
+        storeAssociations();
+    }
+}
 
-        if (newStateUnit == psuUpdateUnit)
-        {
-            if (newStateResult == "done")
-            {
-                onUpdateDone();
-            }
-            if (newStateResult == "failed" || newStateResult == "dependency")
-            {
-                onUpdateFailed();
-            }
-        }
+void Activation::removePsuAssociation(const std::string& psuInventoryPath)
+{
+    if (associationStore.remove(psuInventoryPath) > 0)
+    {
+        storeAssociations();
     }
-    catch (const std::exception& e)
+}
+
+void Activation::storeAssociations()
+{
+    ActivationInherit::associations(associationStore.list(), true);
+    associationsEmitter.schedule();
+}
+
+void Activation::emitAssociations()
+{
+    // The value is already stored, so only the signal is sent. It is sent
+    // even if the list is now empty, e.g. when its last PSU was removed.
+    bus.emit_properties_changed(
+        objPath.str().c_str(),
+        sdbusplus::xyz::openbmc_project::Association::server::Definitions::
+            interface,
+        {"Associations"});
+}
+
+void Activation::unitStateChange(const std::string& result)
+{
+    if (result == "done")
+    {
+        onUpdateDone();
+    }
+    if (result == "failed" || result == "dependency")
+    {
+        onUpdateFailed();
+    }
+}
+
+void Activation::unwatchUpdateUnit()
+{
+    if (!psuUpdateUnit.empty())
     {
-        lg2::error("Unable to handle unit state change event: {ERROR}", "ERROR",
-                   e);
+        jobDispatcher->unwatch(psuUpdateUnit);
+        psuUpdateUnit.clear();
     }
 }
 
 bool Activation::doUpdate(const std::string& psuInventoryPath)
 {
-    currentUpdatingPsu = psuInventoryPath;
+    currentUpdatingPsu = utils::InternedPath(psuInventoryPath);
     try
     {
         psuUpdateUnit = getUpdateService(currentUpdatingPsu);
+        jobDispatcher->watch(psuUpdateUnit, [this](const std::string& result) {
+            unitStateChange(result);
+        });
         auto method = bus.new_method_call(SYSTEMD_BUSNAME, SYSTEMD_PATH,
                                           SYSTEMD_INTERFACE, "StartUnit");
         method.append(psuUpdateUnit, "replace");
@@ -158,17 +207,16 @@ bool Activation::doUpdate()
 
 void Activation::onUpdateDone()
 {
+    unwatchUpdateUnit();
+
     auto progress = activationProgress->progress() + progressStep;
     activationProgress->progress(progress);
 
     // Update the activation association
-    auto assocs = associations();
-    assocs.emplace_back(ACTIVATION_FWD_ASSOCIATION, ACTIVATION_REV_ASSOCIATION,
-                        currentUpdatingPsu);
-    associations(assocs);
+    addPsuAssociation(currentUpdatingPsu);
 
-    activationListener->onUpdateDone(versionId, currentUpdatingPsu);
-    currentUpdatingPsu.clear();
+    activationListener->onUpdateDone(handle, currentUpdatingPsu);
+    currentUpdatingPsu = {};
 
     psuQueue.pop();
     doUpdate(); // Update the next psu
@@ -176,12 +224,16 @@ void Activation::onUpdateDone()
 
 void Activation::onUpdateFailed()
 {
+    unwatchUpdateUnit();
+
     // TODO: report an event
-    lg2::error("Failed to update PSU {PSU}", "PSU", psuQueue.front());
-    std::queue<std::string>().swap(psuQueue); // Clear the queue
+    lg2::error("Failed to update PSU {PSU}", "PSU", psuQueue.front().str());
+    std::queue<utils::InternedPath>().swap(psuQueue); // Clear the queue
+    associationsEmitter.flush();
     activation(Status::Failed);
     requestedActivation(RequestedActivations::None);
     shouldActivateAgain = false;
+    targetPsus.reset();
 }
 
 Activation::Status Activation::startActivation()
@@ -191,32 +243,68 @@ Activation::Status Activation::startActivation()
     {
         lg2::warning(
             "No image for the activation, skipped version {VERSION_ID}",
-            "VERSION_ID", versionId);
+            "VERSION_ID", versionId.str());
         return activation(); // Return the previous activation status
     }
 
-    auto psuPaths = utils::getPSUInventoryPaths(bus);
+    std::vector<std::string> psuPaths;
+    std::vector<std::string> presentPaths;
+    if (auto targets = std::exchange(targetPsus, std::nullopt))
+    {
+        // Only the requested PSUs are considered
+        for (const auto& p : *targets)
+        {
+            psuPaths.push_back(p);
+            if (isPresent(p))
+            {
+                presentPaths.push_back(p);
+            }
+        }
+    }
+    else if (psuCache->seeded())
+    {
+        // The index of the PSU inventory is kept current by ItemUpdater
+        for (const auto& [p, entry] : psuCache->entries())
+        {
+            psuPaths.push_back(p);
+            if (entry.present)
+            {
+                presentPaths.push_back(p);
+            }
+        }
+    }
+    else
+    {
+        // ItemUpdater has not read the whole inventory yet, and owns the
+        // index, so the inventory is only queried here
+        psuPaths = utils::getPSUInventoryPaths(bus);
+        for (const auto& p : psuPaths)
+        {
+            if (isPresent(p))
+            {
+                presentPaths.push_back(p);
+            }
+        }
+    }
     if (psuPaths.empty())
     {
         lg2::warning("No PSU inventory found");
         return Status::Failed;
     }
 
-    for (const auto& p : psuPaths)
+    // Query the models of all present PSUs that are not cached at once
+    auto models = psuCache->getModels(presentPaths);
+    for (const auto& p : presentPaths)
     {
-        if (!isPresent(p))
+        if (isCompatible(p, models[p]))
         {
-            continue;
-        }
-        if (isCompatible(p))
-        {
-            if (utils::isAssociated(p, associations()))
+            if (isAssociated(p))
             {
                 lg2::notice("PSU {PSU} is already running the image, skipping",
                             "PSU", p);
                 continue;
             }
-            psuQueue.push(p);
+            psuQueue.emplace(p);
         }
         else
         {
@@ -259,6 +347,28 @@ Activation::Status Activation::startActivation()
     }
 }
 
+void Activation::activatePsu(const std::string& psuInventoryPath)
+{
+    if (activation() == Status::Activating)
+    {
+        // Update the PSU once the current activation is done, unless all PSUs
+        // are considered then anyway
+        if (!shouldActivateAgain)
+        {
+            shouldActivateAgain = true;
+            targetPsus.emplace();
+        }
+        if (targetPsus)
+        {
+            targetPsus->emplace(psuInventoryPath);
+        }
+        return;
+    }
+    targetPsus.emplace({utils::InternedPath(psuInventoryPath)});
+    requestedActivation(RequestedActivations::Active);
+    targetPsus.reset();
+}
+
 void Activation::finishActivation()
 {
     storeImage();
@@ -266,9 +376,15 @@ void Activation::finishActivation()
 
     deleteImageManagerObject();
 
-    associationInterface->createActiveAssociation(objPath);
-    associationInterface->addFunctionalAssociation(objPath);
-    associationInterface->addUpdateableAssociation(objPath);
+    {
+        AssociationBatch batch(*associationInterface);
+        associationInterface->createActiveAssociation(objPath);
+        associationInterface->addFunctionalAssociation(objPath);
+        associationInterface->addUpdateableAssociation(objPath);
+    }
+
+    // The PSUs running the software are published along with the completion
+    associationsEmitter.flush();
 
     // Reset RequestedActivations to none so that it could be activated in
     // future
@@ -292,13 +408,14 @@ void Activation::deleteImageManagerObject()
     constexpr auto deleteInterface = "xyz.openbmc_project.Object.Delete";
     try
     {
-        services = utils::getServices(bus, objPath.c_str(), deleteInterface);
+        services =
+            utils::getServices(bus, objPath.str().c_str(), deleteInterface);
     }
     catch (const std::exception& e)
     {
         lg2::error(
             "Unable to find services to Delete object path {PATH}: {ERROR}",
-            "PATH", objPath, "ERROR", e);
+            "PATH", objPath.str(), "ERROR", e);
     }
 
     // We need to find the phosphor-version-software-manager's version service
@@ -323,14 +440,15 @@ void Activation::deleteImageManagerObject()
     // Call the Delete object for <versionID> inside image_manager
     try
     {
-        auto method = bus.new_method_call(
-            versionService.c_str(), objPath.c_str(), deleteInterface, "Delete");
+        auto method =
+            bus.new_method_call(versionService.c_str(), objPath.str().c_str(),
+                                deleteInterface, "Delete");
         bus.call(method);
     }
     catch (const std::exception& e)
     {
         lg2::error("Unable to Delete object path {PATH}: {ERROR}", "PATH",
-                   objPath, "ERROR", e);
+                   objPath.str(), "ERROR", e);
     }
 }
 
@@ -339,11 +457,7 @@ bool Activation::isPresent(const std::string& psuInventoryPath)
     bool isPres{false};
     try
     {
-        auto service =
-            utils::getService(bus, psuInventoryPath.c_str(), ITEM_IFACE);
-        isPres = utils::getProperty<bool>(bus, service.c_str(),
-                                          psuInventoryPath.c_str(), ITEM_IFACE,
-                                          PRESENT);
+        isPres = psuCache->isPresent(psuInventoryPath);
     }
     catch (const std::exception& e)
     {
@@ -355,17 +469,13 @@ bool Activation::isPresent(const std::string& psuInventoryPath)
     return isPres;
 }
 
-bool Activation::isCompatible(const std::string& psuInventoryPath)
+bool Activation::isCompatible(const std::string& psuInventoryPath,
+                              const std::string& psuModel)
 {
     bool isCompat{false};
     try
     {
-        auto service =
-            utils::getService(bus, psuInventoryPath.c_str(), ASSET_IFACE);
-        auto psuManufacturer = utils::getProperty<std::string>(
-            bus, service.c_str(), psuInventoryPath.c_str(), ASSET_IFACE,
-            MANUFACTURER);
-        auto psuModel = utils::getModel(psuInventoryPath);
+        auto psuManufacturer = psuCache->getManufacturer(psuInventoryPath);
         // The model shall match
         if (psuModel == model)
         {
@@ -381,7 +491,7 @@ bool Activation::isCompatible(const std::string& psuInventoryPath)
         lg2::error(
             "Unable to determine if PSU {PSU} is compatible with firmware "
             "versionId {VERSION_ID}: {ERROR}",
-            "PSU", psuInventoryPath, "VERSION_ID", versionId, "ERROR", e);
+            "PSU", psuInventoryPath, "VERSION_ID", versionId.str(), "ERROR", e);
     }
     return isCompat;
 }
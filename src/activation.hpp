@@ -4,8 +4,16 @@
 
 #include "activation_listener.hpp"
 #include "association_interface.hpp"
+#include "association_store.hpp"
+#include "debouncer.hpp"
+#include "interned_path.hpp"
+#include "job_dispatcher.hpp"
+#include "manifest.hpp"
+#include "psu_cache.hpp"
+#include "slot_map.hpp"
 #include "types.hpp"
 #include "version.hpp"
+#include "version_id.hpp"
 
 #include <sdbusplus/server.hpp>
 #include <xyz/openbmc_project/Association/Definitions/server.hpp>
@@ -15,7 +23,10 @@
 #include <xyz/openbmc_project/Software/ActivationProgress/server.hpp>
 #include <xyz/openbmc_project/Software/ExtendedVersion/server.hpp>
 
+#include <chrono>
+#include <optional>
 #include <queue>
+#include <set>
 #include <string>
 
 class TestActivation;
@@ -118,40 +129,49 @@ class Activation : public ActivationInherit
      * @param[in] bus    - The Dbus bus object
      * @param[in] path   - The Dbus object path
      * @param[in] versionId  - The software version id
-     * @param[in] extVersion - The extended version
+     * @param[in] handle - The handle of the software of the activation
+     * @param[in] manifest - The manifest of the image, empty for the
+     *                       software running on a PSU
      * @param[in] activationStatus - The status of Activation
      * @param[in] assocs - Association objects
      * @param[in] filePath - The image filesystem path
+     * @param[in] psuCache - The cache of the PSU attributes
+     * @param[in] jobDispatcher - The dispatcher of the systemd jobs
      */
     Activation(sdbusplus::bus_t& bus, const std::string& objPath,
-               const std::string& versionId, const std::string& extVersion,
-               Status activationStatus, const AssociationList& assocs,
-               const std::string& filePath,
+               utils::VersionId versionId, utils::SlotHandle handle,
+               const Manifest& manifest, Status activationStatus,
+               const AssociationList& assocs, const std::string& filePath,
                AssociationInterface* associationInterface,
-               ActivationListener* activationListener) :
+               ActivationListener* activationListener, PsuCache* psuCache,
+               utils::JobDispatcher* jobDispatcher) :
         ActivationInherit(bus, objPath.c_str(),
                           ActivationInherit::action::defer_emit),
-        bus(bus), objPath(objPath), versionId(versionId),
-        systemdSignals(
-            bus,
-            sdbusRule::type::signal() + sdbusRule::member("JobRemoved") +
-                sdbusRule::path("/org/freedesktop/systemd1") +
-                sdbusRule::interface("org.freedesktop.systemd1.Manager"),
-            std::bind(&Activation::unitStateChange, this,
-                      std::placeholders::_1)),
+        bus(bus), objPath(objPath), versionId(versionId), handle(handle),
         associationInterface(associationInterface),
-        activationListener(activationListener)
+        activationListener(activationListener), psuCache(psuCache),
+        jobDispatcher(jobDispatcher), associationStore(assocs)
     {
         // Set Properties.
-        extendedVersion(extVersion);
+        setManifest(manifest);
         activation(activationStatus);
-        associations(assocs);
+        ActivationInherit::associations(assocs, true);
         path(filePath);
 
         // Emit deferred signal.
         emit_object_added();
     }
 
+    Activation(const Activation&) = delete;
+    Activation& operator=(const Activation&) = delete;
+    Activation(Activation&&) = delete;
+    Activation& operator=(Activation&&) = delete;
+
+    ~Activation() override
+    {
+        unwatchUpdateUnit();
+    }
+
     /** @brief Overloaded Activation property setter function
      *
      * @param[in] value - One of Activation::Activations
@@ -172,36 +192,111 @@ class Activation : public ActivationInherit
     RequestedActivations requestedActivation(
         RequestedActivations value) override;
 
-    /** @brief Overloaded ExtendedVersion property setter function
+    /** @brief Set the extended version, model and manufacturer of the image
+     *  @details They are taken as parsed by Manifest::parse().
+     *
+     * @param[in] manifest - The manifest of the image
+     */
+    void setManifest(const Manifest& manifest);
+
+    /** @brief Overloaded FilePath property setter function
+     *  @details The activation listener is notified of the change.
      *
-     * @param[in] value - Extended version value
+     * @param[in] value - The image path
      *
      * @return New value of property
      */
-    std::string extendedVersion(std::string value) override;
+    std::string path(std::string value) override;
+
+    /** @brief FilePath */
+    using ActivationInherit::path;
+
+    /** @brief Overloaded Associations property setter function
+     *  @details The value is stored at once, but the signal is coalesced with
+     *           the other changes made within ASSOCIATION_EMIT_INTERVAL, so
+     *           that updating many PSUs does not emit the growing list after
+     *           each of them.
+     *
+     * @param[in] value - The associations
+     *
+     * @return New value of property
+     */
+    AssociationList associations(AssociationList value) override;
+
+    /** @brief Associations */
+    using ActivationInherit::associations;
+
+    /** @brief Whether the software is associated with the PSU
+     *
+     * @param[in] psuInventoryPath - The PSU inventory path
+     */
+    bool isAssociated(const std::string& psuInventoryPath) const
+    {
+        return associationStore.contains(psuInventoryPath);
+    }
+
+    /** @brief Add the activation association to the PSU
+     *  @details Does nothing if the association already exists.
+     *
+     * @param[in] psuInventoryPath - The PSU inventory path
+     */
+    void addPsuAssociation(const std::string& psuInventoryPath);
+
+    /** @brief Remove the associations to the PSU
+     *
+     * @param[in] psuInventoryPath - The PSU inventory path
+     */
+    void removePsuAssociation(const std::string& psuInventoryPath);
 
     /** @brief Get the object path */
     const std::string& getObjectPath() const
     {
-        return objPath;
+        return objPath.str();
     }
 
     /** @brief Get the version ID */
-    const std::string& getVersionId() const
+    utils::VersionId getVersionId() const
     {
         return versionId;
     }
 
-  private:
-    /** @brief Check if systemd state change is relevant to this object
-     *
-     * Instance specific interface to handle the detected systemd state
-     * change
+    /** @brief Get the handle of the software of the activation */
+    utils::SlotHandle getHandle() const
+    {
+        return handle;
+    }
+
+    /** @brief Get the PSU model of the software */
+    const std::string& getModel() const
+    {
+        return model;
+    }
+
+    /** @brief Activate the software on a single PSU
+     *  @details Only the PSU is considered, instead of all PSUs in the
+     *           inventory. If an activation is in progress, the PSU is updated
+     *           once it is done.
      *
-     * @param[in]  msg       - Data associated with subscribed signal
+     * @param[in] psuInventoryPath - The PSU inventory path
+     */
+    void activatePsu(const std::string& psuInventoryPath);
+
+  private:
+    /** @brief Handle the result of the job of the PSU update unit
      *
+     * @param[in]  result - The result of the job, e.g. "done" or "failed"
      */
-    void unitStateChange(sdbusplus::message_t& msg);
+    void unitStateChange(const std::string& result);
+
+    /** @brief Stop watching the jobs of the PSU update unit */
+    void unwatchUpdateUnit();
+
+    /** @brief Store the associations of the index and schedule their
+     *         signal */
+    void storeAssociations();
+
+    /** @brief Emit the stored associations */
+    void emitAssociations();
 
     /**
      * @brief Delete the version from Image Manager and the
@@ -238,8 +333,13 @@ class Activation : public ActivationInherit
     /** @brief Check if the PSU is present */
     bool isPresent(const std::string& psuInventoryPath);
 
-    /** @brief Check if the PSU is compatible with this software*/
-    bool isCompatible(const std::string& psuInventoryPath);
+    /** @brief Check if the PSU is compatible with this software
+     *
+     * @param[in] psuInventoryPath - The PSU inventory path
+     * @param[in] psuModel - The model reported by the PSU
+     */
+    bool isCompatible(const std::string& psuInventoryPath,
+                      const std::string& psuModel);
 
     /** @brief Store the updated PSU image to persistent dir */
     void storeImage();
@@ -258,16 +358,20 @@ class Activation : public ActivationInherit
     sdbusplus::bus_t& bus;
 
     /** @brief Persistent DBus object path */
-    std::string objPath;
+    utils::InternedPath objPath;
 
     /** @brief Version id */
-    std::string versionId;
+    utils::VersionId versionId;
 
-    /** @brief Used to subscribe to dbus systemd signals */
-    sdbusplus::match systemdSignals;
+    /** @brief The handle of the software of this activation */
+    utils::SlotHandle handle;
 
     /** @brief The queue of psu objects to be updated */
-    std::queue<std::string> psuQueue;
+    std::queue<utils::InternedPath> psuQueue;
+
+    /** @brief The PSUs to consider on the next activation, or nullopt for all
+     * PSUs in the inventory */
+    std::optional<std::set<utils::InternedPath>> targetPsus;
 
     /** @brief The progress step for each PSU update is done */
     uint32_t progressStep;
@@ -276,7 +380,7 @@ class Activation : public ActivationInherit
     std::string psuUpdateUnit;
 
     /** @brief The PSU Inventory path of the current updating PSU */
-    std::string currentUpdatingPsu;
+    utils::InternedPath currentUpdatingPsu;
 
     /** @brief Persistent ActivationBlocksTransition dbus object */
     std::unique_ptr<ActivationBlocksTransition> activationBlocksTransition;
@@ -290,6 +394,12 @@ class Activation : public ActivationInherit
     /** @brief The activationListener pointer */
     ActivationListener* activationListener;
 
+    /** @brief The PsuCache pointer */
+    PsuCache* psuCache;
+
+    /** @brief The JobDispatcher pointer */
+    utils::JobDispatcher* jobDispatcher;
+
     /** @brief The PSU manufacturer of the software */
     std::string manufacturer;
 
@@ -299,6 +409,14 @@ class Activation : public ActivationInherit
     /** @brief Indicates whether to automatically activate again after current
      * request finishes */
     bool shouldActivateAgain{false};
+
+    /** @brief The associations, indexed by endpoint and type */
+    AssociationStore associationStore;
+
+    /** @brief Coalesces the signals of the association changes */
+    utils::Debouncer associationsEmitter{
+        bus.get_event(), std::chrono::milliseconds(ASSOCIATION_EMIT_INTERVAL),
+        [this]() { emitAssociations(); }};
 };
 
 } // namespace updater
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "slot_map.hpp"
+
 #include <string>
 
 class ActivationListener
@@ -15,9 +17,19 @@ class ActivationListener
 
     /** @brief Notify a PSU is updated
      *
-     * @param[in]  versionId - The versionId of the activation
+     * @param[in]  handle - The handle of the software of the activation
      * @param[in]  psuInventoryPath - The PSU inventory path that is updated
      */
-    virtual void onUpdateDone(const std::string& versionId,
+    virtual void onUpdateDone(utils::SlotHandle handle,
                               const std::string& psuInventoryPath) = 0;
+
+    /** @brief Notify the image path of an activation changed
+     *
+     * @param[in]  handle - The handle of the software of the activation
+     * @param[in]  oldPath - The previous image path, or empty
+     * @param[in]  newPath - The new image path, or empty
+     */
+    virtual void onPathChanged(utils::SlotHandle handle,
+                               const std::string& oldPath,
+                               const std::string& newPath) = 0;
 };
@@ -39,4 +39,46 @@ class AssociationInterface
      * @param[in]  path - The path to remove the association from.
      */
     virtual void removeAssociation(const std::string& path) = 0;
+
+    /** @brief Defer the emission of the associations until
+     *  commitAssociations() is called as many times
+     */
+    virtual void beginAssociations() = 0;
+
+    /** @brief Emit the associations changed since the outermost
+     *  beginAssociations() at once
+     */
+    virtual void commitAssociations() = 0;
+};
+
+/** @class AssociationBatch
+ *  @brief Emits the associations changed during its lifetime at once.
+ */
+class AssociationBatch
+{
+  public:
+    AssociationBatch() = delete;
+    AssociationBatch(const AssociationBatch&) = delete;
+    AssociationBatch& operator=(const AssociationBatch&) = delete;
+    AssociationBatch(AssociationBatch&&) = delete;
+    AssociationBatch& operator=(AssociationBatch&&) = delete;
+
+    /** @brief Constructs AssociationBatch
+     *
+     * @param[in]  associationInterface - The owner of the associations
+     */
+    explicit AssociationBatch(AssociationInterface& associationInterface) :
+        associationInterface(associationInterface)
+    {
+        associationInterface.beginAssociations();
+    }
+
+    ~AssociationBatch()
+    {
+        associationInterface.commitAssociations();
+    }
+
+  private:
+    /** @brief The owner of the associations */
+    AssociationInterface& associationInterface;
 };
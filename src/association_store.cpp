@@ -0,0 +1,72 @@
+#include "config.h"
+
+#include "association_store.hpp"
+
+#include <tuple>
+#include <vector>
+
+namespace phosphor
+{
+namespace software
+{
+namespace updater
+{
+
+AssociationStore::AssociationStore(const AssociationList& associations)
+{
+    for (const auto& [forward, reverse, path] : associations)
+    {
+        add(forward, reverse, path);
+    }
+}
+
+bool AssociationStore::add(const std::string& forward,
+                           const std::string& reverse, const std::string& path)
+{
+    if (!byType[{forward, reverse}].insert(path).second)
+    {
+        return false;
+    }
+    ++byPath[path];
+    associations.emplace_back(forward, reverse, path);
+    return true;
+}
+
+size_t AssociationStore::remove(const std::string& path)
+{
+    auto it = byPath.find(path);
+    if (it == byPath.end())
+    {
+        return 0;
+    }
+    auto count = it->second;
+    byPath.erase(it);
+
+    std::erase_if(associations, [this, &path](const auto& association) {
+        const auto& [forward, reverse, endpoint] = association;
+        if (endpoint != path)
+        {
+            return false;
+        }
+        auto type = byType.find({forward, reverse});
+        type->second.erase(path);
+        if (type->second.empty())
+        {
+            byType.erase(type);
+        }
+        return true;
+    });
+    return count;
+}
+
+bool AssociationStore::contains(const std::string& forward,
+                                const std::string& reverse,
+                                const std::string& path) const
+{
+    auto it = byType.find({forward, reverse});
+    return it != byType.end() && it->second.contains(path);
+}
+
+} // namespace updater
+} // namespace software
+} // namespace phosphor
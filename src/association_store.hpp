@@ -0,0 +1,101 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace phosphor
+{
+namespace software
+{
+namespace updater
+{
+
+/** @class AssociationStore
+ *  @brief The associations of a D-Bus object, indexed by endpoint path and by
+ *         type.
+ *  @details The associations are kept in insertion order, in the format of
+ *           the Associations property, along with the indexes that answer
+ *           the membership queries in constant time.
+ */
+class AssociationStore
+{
+  public:
+    /** @brief The forward and reverse names of an association */
+    using Type = std::pair<std::string, std::string>;
+
+    AssociationStore() = default;
+
+    /** @brief Constructs AssociationStore from a property value
+     *  @details Duplicate associations are dropped.
+     *
+     * @param[in] associations - The associations
+     */
+    explicit AssociationStore(const AssociationList& associations);
+
+    /** @brief Add an association
+     *
+     * @param[in] forward - The forward name
+     * @param[in] reverse - The reverse name
+     * @param[in] path - The endpoint path
+     *
+     * @return false if the association already exists
+     */
+    bool add(const std::string& forward, const std::string& reverse,
+             const std::string& path);
+
+    /** @brief Remove all associations to the endpoint
+     *
+     * @param[in] path - The endpoint path
+     *
+     * @return The number of associations removed
+     */
+    size_t remove(const std::string& path);
+
+    /** @brief Whether there is an association to the endpoint */
+    bool contains(const std::string& path) const
+    {
+        return byPath.contains(path);
+    }
+
+    /** @brief Whether there is an association of the type to the endpoint */
+    bool contains(const std::string& forward, const std::string& reverse,
+                  const std::string& path) const;
+
+    /** @brief The associations, in the format of the Associations property */
+    const AssociationList& list() const
+    {
+        return associations;
+    }
+
+    /** @brief Whether there is no association */
+    bool empty() const
+    {
+        return associations.empty();
+    }
+
+    /** @brief The number of associations */
+    size_t size() const
+    {
+        return associations.size();
+    }
+
+  private:
+    /** @brief The associations, in insertion order */
+    AssociationList associations;
+
+    /** @brief The number of associations, by endpoint path */
+    std::unordered_map<std::string, size_t> byPath;
+
+    /** @brief The endpoint paths, by association type */
+    std::map<Type, std::unordered_set<std::string>> byType;
+};
+
+} // namespace updater
+} // namespace software
+} // namespace phosphor
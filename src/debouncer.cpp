@@ -0,0 +1,68 @@
+#include "config.h"
+
+#include "debouncer.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cstring>
+#include <ctime>
+#include <utility>
+
+namespace utils
+{
+
+Debouncer::Debouncer(sd_event* event, std::chrono::milliseconds window,
+                     std::function<void()> callback) :
+    event(event != nullptr ? sd_event_ref(event) : nullptr), window(window),
+    callback(std::move(callback))
+{}
+
+Debouncer::~Debouncer()
+{
+    sd_event_source_disable_unref(timer);
+    sd_event_unref(event);
+}
+
+void Debouncer::schedule()
+{
+    if (timer != nullptr)
+    {
+        // Coalesced with the events already scheduled
+        return;
+    }
+    if (event == nullptr || window.count() <= 0)
+    {
+        callback();
+        return;
+    }
+
+    auto rc = sd_event_add_time_relative(
+        event, &timer, CLOCK_MONOTONIC,
+        std::chrono::duration_cast<std::chrono::microseconds>(window).count(),
+        0, &Debouncer::onTimer, this);
+    if (rc < 0)
+    {
+        lg2::error("Unable to add settle timer: {ERROR}", "ERROR",
+                   std::strerror(-rc));
+        timer = nullptr;
+        callback();
+    }
+}
+
+void Debouncer::flush()
+{
+    if (timer != nullptr)
+    {
+        timer = sd_event_source_disable_unref(timer);
+        callback();
+    }
+}
+
+int Debouncer::onTimer(sd_event_source* /*source*/, uint64_t /*usec*/,
+                       void* userdata)
+{
+    static_cast<Debouncer*>(userdata)->flush();
+    return 0;
+}
+
+} // namespace utils
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <systemd/sd-event.h>
+
+#include <chrono>
+#include <functional>
+
+namespace utils
+{
+
+/** @class Debouncer
+ *  @brief Coalesces a burst of events into a single callback.
+ *  @details The first event of a burst arms a timer, and the callback is
+ *           invoked once the settle window has elapsed, for all the events
+ *           scheduled in the meantime. The window is not extended by later
+ *           events, so a steady stream of events cannot delay the callback
+ *           indefinitely. Without an event loop or with an empty window the
+ *           callback is invoked immediately.
+ */
+class Debouncer
+{
+  public:
+    Debouncer() = delete;
+    Debouncer(const Debouncer&) = delete;
+    Debouncer& operator=(const Debouncer&) = delete;
+    Debouncer(Debouncer&&) = delete;
+    Debouncer& operator=(Debouncer&&) = delete;
+    ~Debouncer();
+
+    /** @brief Constructs Debouncer
+     *
+     * @param[in] event    - The sd-event loop to register with, or nullptr
+     * @param[in] window   - The settle window
+     * @param[in] callback - Invoked once the burst of events has settled
+     */
+    Debouncer(sd_event* event, std::chrono::milliseconds window,
+              std::function<void()> callback);
+
+    /** @brief Schedule the callback at the end of the current burst */
+    void schedule();
+
+    /** @brief Whether the callback is scheduled */
+    bool pending() const
+    {
+        return timer != nullptr;
+    }
+
+    /** @brief Invoke the scheduled callback now, if any */
+    void flush();
+
+  private:
+    /** @brief Called when the settle window has elapsed */
+    static int onTimer(sd_event_source* source, uint64_t usec,
+                       void* userdata);
+
+    /** @brief The sd-event loop, or nullptr */
+    sd_event* event;
+
+    /** @brief The settle window */
+    std::chrono::milliseconds window;
+
+    /** @brief Invoked once the burst of events has settled */
+    std::function<void()> callback;
+
+    /** @brief The timer armed by the first event of the burst */
+    sd_event_source* timer{nullptr};
+};
+
+} // namespace utils
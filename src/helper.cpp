@@ -0,0 +1,566 @@
+#include "config.h"
+
+#include "helper.hpp"
+
+#include "subprocess.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <memory>
+
+namespace utils
+{
+
+namespace // anonymous
+{
+/** @brief The number of times a request is sent before giving up */
+constexpr int MAX_ATTEMPTS = 2;
+
+/** @brief The state of a query of several PSUs */
+struct MultiQuery
+{
+    PathValueMap values;
+    size_t remaining;
+    PathValueCallback callback;
+};
+
+/**
+ * @brief Query several PSUs at once and invoke the callback when all of them
+ *        have answered.
+ */
+void queryAll(const std::vector<std::string>& paths,
+              const std::function<void(const std::string&, StringCallback)>&
+                  query,
+              PathValueCallback callback)
+{
+    if (paths.empty())
+    {
+        callback({});
+        return;
+    }
+
+    auto multi = std::make_shared<MultiQuery>();
+    multi->remaining = paths.size();
+    multi->callback = std::move(callback);
+    for (const auto& path : paths)
+    {
+        query(path, [multi, path](std::string value) {
+            multi->values.emplace(path, std::move(value));
+            if (--multi->remaining == 0)
+            {
+                auto callback = std::move(multi->callback);
+                callback(std::move(multi->values));
+            }
+        });
+    }
+}
+} // namespace
+
+Helper::Helper(sd_event* event, std::vector<std::string> argv,
+               std::chrono::milliseconds timeout) :
+    event(sd_event_ref(event)), argv(std::move(argv)), timeout(timeout)
+{}
+
+Helper::~Helper()
+{
+    for (auto& [id, request] : pending)
+    {
+        sd_event_source_disable_unref(request.timer);
+    }
+    sd_event_source_disable_unref(dispatchSource);
+    stop();
+    sd_event_unref(event);
+}
+
+void Helper::request(const std::string& op,
+                     const std::vector<std::string>& args, Callback callback)
+{
+    if (!send(op, args, callback, false))
+    {
+        callback(unavailable, {});
+    }
+}
+
+std::pair<int, std::string> Helper::call(const std::string& op,
+                                         const std::vector<std::string>& args)
+{
+    syncResponse.reset();
+    auto id = send(op, args, nullptr, true);
+    if (!id)
+    {
+        return {unavailable, {}};
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!syncResponse)
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0)
+        {
+            lg2::error("PSU helper did not respond in time, restarting");
+            pending.erase(*id);
+            restart();
+            syncResponse.emplace(unavailable, std::string{});
+            break;
+        }
+
+        pollfd pfd{sock, POLLIN, 0};
+        auto rc = poll(&pfd, 1, static_cast<int>(remaining.count()));
+        if (rc < 0 && errno != EINTR)
+        {
+            pending.erase(*id);
+            syncResponse.emplace(unavailable, std::string{});
+            break;
+        }
+        if (rc > 0 && !readResponses())
+        {
+            // Sends the request again, or completes it as unavailable
+            restart();
+        }
+    }
+
+    auto response = std::move(*syncResponse);
+    syncResponse.reset();
+    return response;
+}
+
+std::optional<uint64_t> Helper::send(const std::string& op,
+                                     const std::vector<std::string>& args,
+                                     Callback callback, bool sync)
+{
+    // The protocol is line based with tab-separated fields
+    std::string line = std::to_string(nextId) + '\t' + op;
+    for (const auto& arg : args)
+    {
+        if (arg.find_first_of("\t\n") != std::string::npos)
+        {
+            lg2::error("Invalid PSU helper argument {ARG}", "ARG", arg);
+            return std::nullopt;
+        }
+        line += '\t';
+        line += arg;
+    }
+    line += '\n';
+
+    if (!start())
+    {
+        return std::nullopt;
+    }
+
+    auto id = nextId++;
+    auto& request = pending.emplace(id, Request{this, id, std::move(line),
+                                                std::move(callback), sync, 0,
+                                                nullptr})
+                        .first->second;
+    if (!sync)
+    {
+        auto rc = sd_event_add_time_relative(
+            event, &request.timer, CLOCK_MONOTONIC,
+            std::chrono::duration_cast<std::chrono::microseconds>(timeout)
+                .count(),
+            0, &Helper::onTimeout, &request);
+        if (rc < 0)
+        {
+            lg2::error("Unable to add PSU helper request timer: {RC}", "RC",
+                       rc);
+            pending.erase(id);
+            return std::nullopt;
+        }
+    }
+
+    if (!write(request))
+    {
+        // Sends the request again, or completes it as unavailable
+        restart();
+    }
+    return id;
+}
+
+bool Helper::write(Request& request)
+{
+    ++request.attempts;
+    std::string_view data = request.line;
+    while (!data.empty())
+    {
+        auto n = ::send(sock, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            // The helper has exited, or has stopped reading requests
+            lg2::error("Unable to send request to PSU helper: {ERROR}",
+                       "ERROR", std::strerror(errno));
+            return false;
+        }
+        data.remove_prefix(n);
+    }
+    return true;
+}
+
+bool Helper::start()
+{
+    if (pid > 0)
+    {
+        return true;
+    }
+
+    if (!dispatchSource)
+    {
+        auto rc = sd_event_add_defer(event, &dispatchSource,
+                                     &Helper::onDispatch, this);
+        if (rc < 0)
+        {
+            lg2::error("Unable to add PSU helper event source: {RC}", "RC",
+                       rc);
+            return false;
+        }
+        sd_event_source_set_enabled(dispatchSource, SD_EVENT_OFF);
+    }
+
+    std::array<int, 2> fds{};
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds.data()) != 0)
+    {
+        lg2::error("Unable to create PSU helper socket: {ERROR}", "ERROR",
+                   std::strerror(errno));
+        return false;
+    }
+
+    try
+    {
+        pid = spawn(argv, fds[1], fds[1]);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Unable to start PSU helper: {ERROR}", "ERROR", e);
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    close(fds[1]);
+    sock = fds[0];
+    buffer.clear();
+
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) | O_NONBLOCK);
+    auto rc = sd_event_add_io(event, &sockSource, sock, EPOLLIN,
+                              &Helper::onResponse, this);
+    if (rc < 0)
+    {
+        lg2::error("Unable to watch PSU helper: {RC}", "RC", rc);
+        stop();
+        return false;
+    }
+
+    lg2::info("Started PSU helper {CMD}, pid {PID}", "CMD", argv[0], "PID",
+              pid);
+    return true;
+}
+
+void Helper::stop()
+{
+    sockSource = sd_event_source_disable_unref(sockSource);
+    if (sock >= 0)
+    {
+        close(sock);
+        sock = -1;
+    }
+    if (pid > 0)
+    {
+        kill(pid, SIGKILL);
+        while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR)
+        {}
+        pid = -1;
+    }
+}
+
+void Helper::restart()
+{
+    stop();
+
+    std::vector<uint64_t> failed;
+    for (auto& [id, request] : pending)
+    {
+        if (request.attempts >= MAX_ATTEMPTS || !start() || !write(request))
+        {
+            failed.push_back(id);
+        }
+    }
+    for (auto id : failed)
+    {
+        complete(id, unavailable, {});
+    }
+}
+
+bool Helper::readResponses()
+{
+    bool open = true;
+    std::array<char, 512> data;
+    while (true)
+    {
+        auto n = recv(sock, data.data(), data.size(), 0);
+        if (n > 0)
+        {
+            buffer.append(data.data(), n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        open = (n < 0 && errno == EAGAIN);
+        break;
+    }
+
+    size_t pos = 0;
+    for (auto end = buffer.find('\n'); end != std::string::npos;
+         pos = end + 1, end = buffer.find('\n', pos))
+    {
+        std::string_view line(buffer.data() + pos, end - pos);
+        auto tab1 = line.find('\t');
+        auto tab2 = line.find('\t', tab1 + 1);
+        uint64_t id{};
+        int status{};
+        if (tab1 == std::string_view::npos || tab2 == std::string_view::npos ||
+            std::from_chars(line.data(), line.data() + tab1, id).ec !=
+                std::errc{} ||
+            std::from_chars(line.data() + tab1 + 1, line.data() + tab2,
+                            status)
+                    .ec != std::errc{})
+        {
+            lg2::error("Invalid response from PSU helper: {LINE}", "LINE",
+                       line);
+            continue;
+        }
+        complete(id, status, std::string{line.substr(tab2 + 1)});
+    }
+    buffer.erase(0, pos);
+
+    if (buffer.size() > PSU_UTIL_MAX_OUTPUT)
+    {
+        lg2::error("PSU helper response exceeded {LIMIT} bytes", "LIMIT",
+                   PSU_UTIL_MAX_OUTPUT);
+        buffer.clear();
+        return false;
+    }
+    return open;
+}
+
+void Helper::complete(uint64_t id, int status, std::string value)
+{
+    auto it = pending.find(id);
+    if (it == pending.end())
+    {
+        // A response to a request that has already timed out
+        return;
+    }
+
+    auto request = std::move(it->second);
+    pending.erase(it);
+    sd_event_source_disable_unref(request.timer);
+    if (request.sync)
+    {
+        syncResponse.emplace(status, std::move(value));
+        return;
+    }
+    completed.emplace_back(std::move(request.callback), status,
+                           std::move(value));
+    sd_event_source_set_enabled(dispatchSource, SD_EVENT_ONESHOT);
+}
+
+void Helper::dispatch()
+{
+    // The callbacks may send new requests
+    auto callbacks = std::move(completed);
+    completed.clear();
+    for (auto& [callback, status, value] : callbacks)
+    {
+        try
+        {
+            callback(status, std::move(value));
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Unable to handle PSU helper response: {ERROR}",
+                       "ERROR", e);
+        }
+    }
+}
+
+int Helper::onResponse(sd_event_source* /*source*/, int /*fd*/,
+                       uint32_t /*revents*/, void* userdata)
+{
+    auto* helper = static_cast<Helper*>(userdata);
+    if (!helper->readResponses())
+    {
+        lg2::error("PSU helper exited, restarting");
+        helper->restart();
+    }
+    helper->dispatch();
+    return 0;
+}
+
+int Helper::onTimeout(sd_event_source* /*source*/, uint64_t /*usec*/,
+                      void* userdata)
+{
+    auto* request = static_cast<Request*>(userdata);
+    auto* helper = request->helper;
+    lg2::error("PSU helper did not respond in time, restarting");
+    helper->complete(request->id, unavailable, {});
+    helper->restart();
+    helper->dispatch();
+    return 0;
+}
+
+int Helper::onDispatch(sd_event_source* /*source*/, void* userdata)
+{
+    static_cast<Helper*>(userdata)->dispatch();
+    return 0;
+}
+
+HelperUtils::HelperUtils(sd_event* event, std::string_view command,
+                         std::chrono::milliseconds timeout) :
+    helper(event, splitCommand(command), timeout)
+{}
+
+std::string HelperUtils::getVersion(const std::string& inventoryPath) const
+{
+    auto [status, value] = helper.call("get-version", {inventoryPath});
+    if (status == Helper::unavailable)
+    {
+        return Utils::getVersion(inventoryPath);
+    }
+    return status == 0 ? value : std::string{};
+}
+
+std::string HelperUtils::getModel(const std::string& inventoryPath) const
+{
+    auto [status, value] = helper.call("get-model", {inventoryPath});
+    if (status == Helper::unavailable)
+    {
+        return Utils::getModel(inventoryPath);
+    }
+    return status == 0 ? value : std::string{};
+}
+
+std::string HelperUtils::getLatestVersion(
+    const std::set<std::string>& versions) const
+{
+    if (versions.empty())
+    {
+        return {};
+    }
+    std::vector<std::string> args(versions.begin(), versions.end());
+    auto [status, value] = helper.call("compare", args);
+    if (status == Helper::unavailable)
+    {
+        return Utils::getLatestVersion(versions);
+    }
+    return status == 0 ? value : std::string{};
+}
+
+void HelperUtils::getVersionAsync(const std::string& inventoryPath,
+                                  StringCallback callback) const
+{
+    helper.request("get-version", {inventoryPath},
+                   [this, inventoryPath, callback](int status,
+                                                   std::string value) {
+                       if (status == Helper::unavailable)
+                       {
+                           Utils::getVersionAsync(inventoryPath, callback);
+                           return;
+                       }
+                       callback(status == 0 ? std::move(value)
+                                            : std::string{});
+                   });
+}
+
+void HelperUtils::getModelAsync(const std::string& inventoryPath,
+                                StringCallback callback) const
+{
+    helper.request("get-model", {inventoryPath},
+                   [this, inventoryPath, callback](int status,
+                                                   std::string value) {
+                       if (status == Helper::unavailable)
+                       {
+                           Utils::getModelAsync(inventoryPath, callback);
+                           return;
+                       }
+                       callback(status == 0 ? std::move(value)
+                                            : std::string{});
+                   });
+}
+
+void HelperUtils::getLatestVersionAsync(const std::set<std::string>& versions,
+                                        StringCallback callback) const
+{
+    if (versions.empty())
+    {
+        callback({});
+        return;
+    }
+    std::vector<std::string> args(versions.begin(), versions.end());
+    helper.request("compare", args,
+                   [this, versions, callback](int status, std::string value) {
+                       if (status == Helper::unavailable)
+                       {
+                           Utils::getLatestVersionAsync(versions, callback);
+                           return;
+                       }
+                       callback(status == 0 ? std::move(value)
+                                            : std::string{});
+                   });
+}
+
+PathValueMap HelperUtils::getVersions(
+    const std::vector<std::string>& inventoryPaths) const
+{
+    // The helper has no process startup cost, so query the PSUs one by one
+    return UtilsInterface::getVersions(inventoryPaths);
+}
+
+PathValueMap HelperUtils::getModels(
+    const std::vector<std::string>& inventoryPaths) const
+{
+    return UtilsInterface::getModels(inventoryPaths);
+}
+
+void HelperUtils::getVersionsAsync(
+    const std::vector<std::string>& inventoryPaths,
+    PathValueCallback callback) const
+{
+    // Pipeline the requests for all PSUs
+    queryAll(
+        inventoryPaths,
+        [this](const std::string& path, StringCallback cb) {
+            getVersionAsync(path, std::move(cb));
+        },
+        std::move(callback));
+}
+
+void HelperUtils::getModelsAsync(const std::vector<std::string>& inventoryPaths,
+                                 PathValueCallback callback) const
+{
+    queryAll(
+        inventoryPaths,
+        [this](const std::string& path, StringCallback cb) {
+            getModelAsync(path, std::move(cb));
+        },
+        std::move(callback));
+}
+
+} // namespace utils
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "utils.hpp"
+
+#include <systemd/sd-event.h>
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace utils
+{
+
+/** @class Helper
+ *  @brief A long-lived vendor tool running as a co-process.
+ *  @details The helper is started on the first request and reads requests
+ *           from its stdin, one per line, as tab-separated fields:
+ *             <id>\t<op>\t<arg>...
+ *           It answers each request with a line on its stdout:
+ *             <id>\t<status>\t<value>
+ *           where status 0 means success. Responses may be sent in any order,
+ *           so several requests can be outstanding at once. If the helper
+ *           exits or does not answer in time it is restarted, and the
+ *           outstanding requests are sent again once.
+ */
+class Helper
+{
+  public:
+    /** @brief The status reported when the helper could not answer */
+    static constexpr int unavailable = -1;
+
+    /** @brief Callback invoked with the response status and value */
+    using Callback = std::function<void(int status, std::string value)>;
+
+    Helper() = delete;
+    Helper(const Helper&) = delete;
+    Helper& operator=(const Helper&) = delete;
+    Helper(Helper&&) = delete;
+    Helper& operator=(Helper&&) = delete;
+    ~Helper();
+
+    /** @brief Constructs Helper
+     *
+     * @param[in] event   - The sd-event loop to register with
+     * @param[in] argv    - The helper executable and its arguments
+     * @param[in] timeout - How long to wait for each response
+     */
+    Helper(sd_event* event, std::vector<std::string> argv,
+           std::chrono::milliseconds timeout);
+
+    /** @brief Send a request and return without waiting for the response
+     *
+     *  @details The callback is invoked from the event loop, or immediately
+     *           with status unavailable if the request cannot be sent.
+     *
+     * @param[in] op       - The operation, e.g. "get-version"
+     * @param[in] args     - The arguments of the operation
+     * @param[in] callback - Invoked with the response
+     */
+    void request(const std::string& op, const std::vector<std::string>& args,
+                 Callback callback);
+
+    /** @brief Send a request and wait for the response
+     *
+     *  @details Responses to other outstanding requests that arrive in the
+     *           meantime are dispatched later from the event loop.
+     *
+     * @param[in] op   - The operation, e.g. "get-version"
+     * @param[in] args - The arguments of the operation
+     *
+     * @return The response status and value
+     */
+    std::pair<int, std::string> call(const std::string& op,
+                                      const std::vector<std::string>& args);
+
+  private:
+    /** @brief An outstanding request */
+    struct Request
+    {
+        Helper* helper;
+        uint64_t id;
+        std::string line;
+        Callback callback;
+        bool sync;
+        int attempts;
+        sd_event_source* timer;
+    };
+
+    /** @brief Queue a request and send it to the helper
+     *
+     * @return The request ID, or nullopt if it could not be sent
+     */
+    std::optional<uint64_t> send(const std::string& op,
+                                 const std::vector<std::string>& args,
+                                 Callback callback, bool sync);
+
+    /** @brief Write the request to the helper; returns false on failure */
+    bool write(Request& request);
+
+    /** @brief Start the helper if it is not running */
+    bool start();
+
+    /** @brief Kill and reap the helper */
+    void stop();
+
+    /** @brief Restart the helper and send the outstanding requests again */
+    void restart();
+
+    /** @brief Read the available responses from the helper
+     *
+     * @return false if the helper has closed its stdout
+     */
+    bool readResponses();
+
+    /** @brief Complete a request with the response */
+    void complete(uint64_t id, int status, std::string value);
+
+    /** @brief Invoke the callbacks of the completed requests */
+    void dispatch();
+
+    /** @brief sd-event callback for the helper socket */
+    static int onResponse(sd_event_source* source, int fd, uint32_t revents,
+                          void* userdata);
+
+    /** @brief sd-event callback for a request timeout */
+    static int onTimeout(sd_event_source* source, uint64_t usec,
+                         void* userdata);
+
+    /** @brief sd-event callback to dispatch deferred completions */
+    static int onDispatch(sd_event_source* source, void* userdata);
+
+    /** @brief The sd-event loop */
+    sd_event* event;
+
+    /** @brief The helper executable and its arguments */
+    std::vector<std::string> argv;
+
+    /** @brief How long to wait for each response */
+    std::chrono::milliseconds timeout;
+
+    /** @brief The helper process ID */
+    pid_t pid{-1};
+
+    /** @brief The socket connected to the helper's stdin and stdout */
+    int sock{-1};
+
+    /** @brief Event source for sock */
+    sd_event_source* sockSource{nullptr};
+
+    /** @brief Event source to dispatch deferred completions */
+    sd_event_source* dispatchSource{nullptr};
+
+    /** @brief Partial response line read from the helper */
+    std::string buffer;
+
+    /** @brief The ID of the next request */
+    uint64_t nextId{1};
+
+    /** @brief The outstanding requests */
+    std::map<uint64_t, Request> pending;
+
+    /** @brief The completed requests whose callbacks are yet to be invoked */
+    std::vector<std::tuple<Callback, int, std::string>> completed;
+
+    /** @brief The response of the synchronous request */
+    std::optional<std::pair<int, std::string>> syncResponse;
+};
+
+/** @class HelperUtils
+ *  @brief Gets the PSU versions and models from a helper co-process.
+ *  @details Falls back to running the PSU_*_UTIL tools when the helper is
+ *           unavailable.
+ */
+class HelperUtils : public Utils
+{
+  public:
+    /** @brief Constructs HelperUtils
+     *
+     * @param[in] event   - The sd-event loop to register with
+     * @param[in] command - The helper command and its fixed arguments
+     * @param[in] timeout - How long to wait for each response
+     */
+    HelperUtils(sd_event* event, std::string_view command,
+                std::chrono::milliseconds timeout);
+
+    std::string getVersion(const std::string& inventoryPath) const override;
+
+    std::string getModel(const std::string& inventoryPath) const override;
+
+    std::string getLatestVersion(
+        const std::set<std::string>& versions) const override;
+
+    void getVersionAsync(const std::string& inventoryPath,
+                         StringCallback callback) const override;
+
+    void getModelAsync(const std::string& inventoryPath,
+                       StringCallback callback) const override;
+
+    void getLatestVersionAsync(const std::set<std::string>& versions,
+                               StringCallback callback) const override;
+
+    PathValueMap getVersions(
+        const std::vector<std::string>& inventoryPaths) const override;
+
+    PathValueMap getModels(
+        const std::vector<std::string>& inventoryPaths) const override;
+
+    void getVersionsAsync(const std::vector<std::string>& inventoryPaths,
+                          PathValueCallback callback) const override;
+
+    void getModelsAsync(const std::vector<std::string>& inventoryPaths,
+                        PathValueCallback callback) const override;
+
+  private:
+    /** @brief The helper co-process */
+    mutable Helper helper;
+};
+
+} // namespace utils
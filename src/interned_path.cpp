@@ -0,0 +1,145 @@
+#include "config.h"
+
+#include "interned_path.hpp"
+
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace utils
+{
+
+namespace // anonymous
+{
+/** @brief An interned path and the number of handles referring to it */
+struct Entry
+{
+    std::string path;
+    uint32_t refs{0};
+};
+
+/** @brief The process-wide table of the interned paths */
+struct Table
+{
+    /** @brief The paths by index, stable across insertions */
+    std::deque<Entry> entries = std::deque<Entry>(1);
+
+    /** @brief The indexes of the released entries, reused first */
+    std::vector<uint32_t> freeList;
+
+    /** @brief The indexes by path, viewing the strings of entries */
+    std::unordered_map<std::string_view, uint32_t> indexes;
+};
+
+Table& table()
+{
+    static Table table;
+    return table;
+}
+} // namespace
+
+InternedPath::InternedPath(std::string_view path)
+{
+    if (path.empty())
+    {
+        return;
+    }
+    auto& t = table();
+    auto it = t.indexes.find(path);
+    if (it != t.indexes.end())
+    {
+        index = it->second;
+        ++t.entries[index].refs;
+        return;
+    }
+    if (t.freeList.empty())
+    {
+        index = static_cast<uint32_t>(t.entries.size());
+        t.entries.emplace_back();
+    }
+    else
+    {
+        index = t.freeList.back();
+        t.freeList.pop_back();
+    }
+    auto& entry = t.entries[index];
+    entry.path = path;
+    entry.refs = 1;
+    t.indexes.emplace(entry.path, index);
+}
+
+InternedPath::InternedPath(const InternedPath& other) : index(other.index)
+{
+    if (index != 0)
+    {
+        ++table().entries[index].refs;
+    }
+}
+
+InternedPath& InternedPath::operator=(const InternedPath& other)
+{
+    if (index != other.index)
+    {
+        InternedPath copy(other);
+        std::swap(index, copy.index);
+    }
+    return *this;
+}
+
+InternedPath::InternedPath(InternedPath&& other) noexcept :
+    index(std::exchange(other.index, 0))
+{}
+
+InternedPath& InternedPath::operator=(InternedPath&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        index = std::exchange(other.index, 0);
+    }
+    return *this;
+}
+
+InternedPath::~InternedPath()
+{
+    release();
+}
+
+void InternedPath::release() noexcept
+{
+    if (index == 0)
+    {
+        return;
+    }
+    auto& t = table();
+    auto& entry = t.entries[index];
+    if (--entry.refs == 0)
+    {
+        t.indexes.erase(entry.path);
+        std::string().swap(entry.path);
+        t.freeList.push_back(index);
+    }
+    index = 0;
+}
+
+const std::string& InternedPath::str() const
+{
+    return table().entries[index].path;
+}
+
+std::strong_ordering InternedPath::operator<=>(const InternedPath& other) const
+{
+    if (index == other.index)
+    {
+        return std::strong_ordering::equal;
+    }
+    return str() <=> other.str();
+}
+
+size_t InternedPath::count()
+{
+    return table().indexes.size();
+}
+
+} // namespace utils
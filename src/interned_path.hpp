@@ -0,0 +1,87 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace utils
+{
+
+/** @class InternedPath
+ *  @brief A compact handle of a D-Bus object path.
+ *  @details Each distinct path is stored once in a process-wide table, so
+ *           that the structures referring to the same PSU or software object
+ *           share a single string. The entries are reference counted, and
+ *           released with the last handle of the path, so the paths of the
+ *           erased software objects do not accumulate. Handles are compared
+ *           for equality by index, while ordering follows the strings, so
+ *           that ordered containers keep iterating in path order. The table
+ *           is not thread-safe, as all the D-Bus handling runs on the event
+ *           loop.
+ */
+class InternedPath
+{
+  public:
+    /** @brief Constructs the handle of the empty path */
+    InternedPath() = default;
+
+    /** @brief Constructs the handle of the path, interning it if needed
+     *
+     * @param[in] path - The D-Bus object path
+     */
+    explicit InternedPath(std::string_view path);
+
+    InternedPath(const InternedPath& other);
+    InternedPath& operator=(const InternedPath& other);
+    InternedPath(InternedPath&& other) noexcept;
+    InternedPath& operator=(InternedPath&& other) noexcept;
+    ~InternedPath();
+
+    /** @brief Get the path */
+    const std::string& str() const;
+
+    /** @brief Get the path, at the D-Bus boundary */
+    operator const std::string&() const
+    {
+        return str();
+    }
+
+    /** @brief Whether the path is empty */
+    bool empty() const
+    {
+        return index == 0;
+    }
+
+    bool operator==(const InternedPath&) const = default;
+
+    std::strong_ordering operator<=>(const InternedPath& other) const;
+
+    /** @brief Compare with a string, without interning it */
+    friend bool operator==(const InternedPath& lhs, std::string_view rhs)
+    {
+        return lhs.str() == rhs;
+    }
+
+    /** @brief Order against a string, without interning it
+     *  @details This allows transparent lookups with std::less<>.
+     */
+    friend std::strong_ordering operator<=>(const InternedPath& lhs,
+                                            std::string_view rhs)
+    {
+        return std::string_view(lhs.str()) <=> rhs;
+    }
+
+    /** @brief The number of distinct paths currently interned */
+    static size_t count();
+
+  private:
+    /** @brief Release the reference of the handle to its path */
+    void release() noexcept;
+
+    /** @brief The index of the path in the table, 0 being the empty path */
+    uint32_t index{0};
+};
+
+} // namespace utils
@@ -2,6 +2,7 @@
 
 #include "item_updater.hpp"
 
+#include "manifest.hpp"
 #include "runtime_warning.hpp"
 #include "utils.hpp"
 
@@ -9,17 +10,14 @@
 #include <phosphor-logging/lg2.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
 
+#include <algorithm>
 #include <exception>
 #include <filesystem>
 #include <format>
+#include <memory>
 #include <set>
 #include <stdexcept>
-
-namespace
-{
-constexpr auto MANIFEST_VERSION = "version";
-constexpr auto MANIFEST_EXTENDED_VERSION = "extended_version";
-} // namespace
+#include <utility>
 
 namespace phosphor
 {
@@ -112,9 +110,27 @@ void ItemUpdater::onVersionInterfacesAdded(const std::string& path,
         return;
     }
 
-    auto versionId = path.substr(pos + 1);
+    auto versionId = utils::VersionId::parse(path.substr(pos + 1));
+    if (!versionId)
+    {
+        lg2::error("Invalid version id in object path {OBJPATH}", "OBJPATH",
+                   path);
+        return;
+    }
 
-    if (activations.find(versionId) == activations.end())
+    if (const auto* other = versionIdRegistry.findVersion(*versionId))
+    {
+        // The image manager hashes the versions alike, but its ids are not
+        // disambiguated, so an image whose id is in use is not handled
+        if (*other != version)
+        {
+            lg2::error("Version id {VERSION_ID} of {VERSION} is in use by "
+                       "{OTHER}, ignoring the image {OBJPATH}",
+                       "VERSION_ID", versionId->str(), "VERSION", version,
+                       "OTHER", *other, "OBJPATH", path);
+        }
+    }
+    else
     {
         // Determine the Activation state by processing the given image dir.
         AssociationList associations;
@@ -126,137 +142,218 @@ void ItemUpdater::onVersionInterfacesAdded(const std::string& path,
 
         fs::path manifestPath(filePath);
         manifestPath /= MANIFEST_FILE;
-        std::string extendedVersion =
-            Version::getValue(manifestPath, {MANIFEST_EXTENDED_VERSION});
+        auto manifest = Manifest::read(manifestPath);
 
-        auto activation =
-            createActivationObject(path, versionId, extendedVersion,
-                                   activationState, associations, filePath);
-        activations.emplace(versionId, std::move(activation));
-
-        auto versionPtr =
-            createVersionObject(path, versionId, version, purpose);
-        versions.emplace(versionId, std::move(versionPtr));
+        createSoftware(path, *versionId, manifest.value_or(Manifest{}),
+                       activationState, associations, filePath, version);
     }
 }
 
-void ItemUpdater::erase(const std::string& versionId)
+void ItemUpdater::erase(utils::SlotHandle handle)
 {
-    auto it = versions.find(versionId);
-    if (it == versions.end())
+    auto* entry = software.find(handle);
+    if (entry == nullptr)
     {
-        lg2::error("Error: Failed to find version {VERSION_ID} in "
-                   "item updater versions map. Unable to remove.",
-                   "VERSION_ID", versionId);
-    }
-    else
-    {
-        versionStrings.erase(it->second->getVersionString());
-        versions.erase(it);
+        lg2::error("Error: Failed to find software {INDEX} in "
+                   "item updater software map. Unable to remove.",
+                   "INDEX", handle.index);
+        return;
     }
-
-    // Removing entry in activations map
-    auto ita = activations.find(versionId);
-    if (ita == activations.end())
+    auto versionId = entry->activation->getVersionId();
+    if (const auto& version = entry->version)
     {
-        lg2::error("Error: Failed to find version {VERSION_ID} in "
-                   "item updater activations map. Unable to remove.",
-                   "VERSION_ID", versionId);
+        const auto& versionString = version->getVersionString();
+        auto itv = versionIds.find(versionString);
+        if (itv != versionIds.end() && itv->second == versionId)
+        {
+            versionIds.erase(itv);
+        }
     }
-    else
+    versionIdRegistry.erase(versionId);
+    auto its = softwareIds.find(versionId);
+    if (its != softwareIds.end() && its->second == handle)
     {
-        activations.erase(versionId);
+        softwareIds.erase(its);
     }
+    onPathChanged(handle, entry->activation->path(), "");
+    software.erase(handle);
 }
 
 void ItemUpdater::createActiveAssociation(const std::string& path)
 {
-    assocs.emplace_back(
-        std::make_tuple(ACTIVE_FWD_ASSOCIATION, ACTIVE_REV_ASSOCIATION, path));
-    associations(assocs);
+    assocs.add(ACTIVE_FWD_ASSOCIATION, ACTIVE_REV_ASSOCIATION, path);
+    emitAssociations();
 }
 
 void ItemUpdater::addFunctionalAssociation(const std::string& path)
 {
-    assocs.emplace_back(std::make_tuple(FUNCTIONAL_FWD_ASSOCIATION,
-                                        FUNCTIONAL_REV_ASSOCIATION, path));
-    associations(assocs);
+    assocs.add(FUNCTIONAL_FWD_ASSOCIATION, FUNCTIONAL_REV_ASSOCIATION, path);
+    emitAssociations();
 }
 
 void ItemUpdater::addUpdateableAssociation(const std::string& path)
 {
-    assocs.emplace_back(std::make_tuple(UPDATEABLE_FWD_ASSOCIATION,
-                                        UPDATEABLE_REV_ASSOCIATION, path));
-    associations(assocs);
+    assocs.add(UPDATEABLE_FWD_ASSOCIATION, UPDATEABLE_REV_ASSOCIATION, path);
+    emitAssociations();
 }
 
 void ItemUpdater::removeAssociation(const std::string& path)
 {
-    for (auto iter = assocs.begin(); iter != assocs.end();)
+    assocs.remove(path);
+    emitAssociations();
+}
+
+void ItemUpdater::beginAssociations()
+{
+    ++associationBatchDepth;
+}
+
+void ItemUpdater::commitAssociations()
+{
+    if (associationBatchDepth > 0 && --associationBatchDepth == 0)
     {
-        if ((std::get<2>(*iter)) == path)
-        {
-            iter = assocs.erase(iter);
-            associations(assocs);
-        }
-        else
-        {
-            ++iter;
-        }
+        emitAssociations();
     }
 }
 
-void ItemUpdater::onUpdateDone(const std::string& versionId,
+void ItemUpdater::emitAssociations()
+{
+    // A single PropertiesChanged signal is sent for all changes of a batch,
+    // and none if they cancel out
+    if (associationBatchDepth == 0 && associations() != assocs.list())
+    {
+        associations(assocs.list());
+    }
+}
+
+void ItemUpdater::onUpdateDone(utils::SlotHandle handle,
                                const std::string& psuInventoryPath)
 {
-    // After update is done, remove old activation objects
-    for (auto it = activations.begin(); it != activations.end(); ++it)
+    // The PSU is running new firmware
+    psuCache.invalidate(psuInventoryPath);
+
+    // After update is done, remove the association to the old activation
+    auto old = psuPathActivationMap.find(psuInventoryPath);
+    if (old != psuPathActivationMap.end() && old->second != handle)
     {
-        if (it->second->getVersionId() != versionId &&
-            utils::isAssociated(psuInventoryPath, it->second->associations()))
-        {
-            removePsuObject(psuInventoryPath);
-            break;
-        }
+        removePsuObject(psuInventoryPath);
     }
 
-    auto it = activations.find(versionId);
-    if (it == activations.end())
+    if (!software.contains(handle))
     {
-        lg2::error("Unable to find Activation for version ID {VERSION_ID}",
-                   "VERSION_ID", versionId);
+        lg2::error("Unable to find Activation for software {INDEX}", "INDEX",
+                   handle.index);
     }
     else
     {
-        psuPathActivationMap.emplace(psuInventoryPath, it->second);
+        psuPathActivationMap.emplace(psuInventoryPath, handle);
+    }
+}
+
+std::optional<ItemUpdater::ImageSource> ItemUpdater::getImageSource(
+    const std::string& path)
+{
+    // The image dirs are configurable, so the specific ones are checked first
+    if (path.starts_with(IMG_DIR_BUILTIN))
+    {
+        return ImageSource::builtin;
+    }
+    if (path.starts_with(IMG_DIR_PERSIST))
+    {
+        return ImageSource::persist;
+    }
+    if (path.starts_with(IMG_DIR))
+    {
+        return ImageSource::tmp;
+    }
+    return std::nullopt;
+}
+
+void ItemUpdater::onPathChanged(utils::SlotHandle handle,
+                                const std::string& oldPath,
+                                const std::string& newPath)
+{
+    if (auto source = getImageSource(oldPath))
+    {
+        auto it = imageSourceIndex.find(*source);
+        if (it != imageSourceIndex.end())
+        {
+            it->second.erase(handle);
+        }
+    }
+    if (auto source = getImageSource(newPath))
+    {
+        imageSourceIndex[*source].insert(handle);
     }
 }
 
 std::unique_ptr<Activation> ItemUpdater::createActivationObject(
-    const std::string& path, const std::string& versionId,
-    const std::string& extVersion, Activation::Status activationStatus,
-    const AssociationList& assocs, const std::string& filePath)
+    const std::string& path, utils::VersionId versionId,
+    utils::SlotHandle handle, const Manifest& manifest,
+    Activation::Status activationStatus, const AssociationList& assocs,
+    const std::string& filePath)
 {
-    return std::make_unique<Activation>(bus, path, versionId, extVersion,
-                                        activationStatus, assocs, filePath,
-                                        this, this);
+    return std::make_unique<Activation>(
+        bus, path, versionId, handle, manifest, activationStatus, assocs,
+        filePath, this, this, &psuCache, &jobDispatcher);
+}
+
+utils::SlotHandle ItemUpdater::createSoftware(
+    const std::string& path, utils::VersionId versionId,
+    const Manifest& manifest, Activation::Status activationStatus,
+    const AssociationList& assocs, const std::string& filePath,
+    const std::string& versionString)
+{
+    // The objects are given the handle of their record, which they report
+    // back in the listener and erase callbacks
+    auto handle = software.insertWith([&](utils::SlotHandle slot) {
+        auto activation =
+            createActivationObject(path, versionId, slot, manifest,
+                                   activationStatus, assocs, filePath);
+        auto version = createVersionObject(path, versionId, slot,
+                                           versionString, VersionPurpose::PSU);
+        return Software{std::move(activation), std::move(version)};
+    });
+    softwareIds.insert_or_assign(versionId, handle);
+    return handle;
+}
+
+Software* ItemUpdater::findSoftware(utils::VersionId versionId)
+{
+    auto it = softwareIds.find(versionId);
+    if (it == softwareIds.end())
+    {
+        return nullptr;
+    }
+    return software.find(it->second);
 }
 
 void ItemUpdater::createPsuObject(const std::string& psuInventoryPath,
                                   const std::string& psuVersion)
 {
-    auto versionId = utils::getVersionId(psuVersion);
-    auto path = std::string(SOFTWARE_OBJPATH) + "/" + versionId;
+    auto versionId = versionIdRegistry.resolve(psuVersion);
+    if (!versionId)
+    {
+        return;
+    }
+    auto path = std::string(SOFTWARE_OBJPATH) + "/" + versionId->str();
 
-    auto it = activations.find(versionId);
-    if (it != activations.end())
+    auto it = softwareIds.find(*versionId);
+    if (it != softwareIds.end())
     {
         // The versionId is already created, associate the path
-        auto associations = it->second->associations();
-        associations.emplace_back(
-            std::make_tuple(ACTIVATION_FWD_ASSOCIATION,
-                            ACTIVATION_REV_ASSOCIATION, psuInventoryPath));
-        it->second->associations(associations);
+        const auto& activation = software.find(it->second)->activation;
+        if (activation->associations().empty() &&
+            activation->activation() == Activation::Status::Ready)
+        {
+            // The stored image is running on a PSU again
+            activation->activation(Activation::Status::Active);
+            AssociationBatch batch(*this);
+            createActiveAssociation(activation->getObjectPath());
+            addFunctionalAssociation(activation->getObjectPath());
+            addUpdateableAssociation(activation->getObjectPath());
+        }
+        activation->addPsuAssociation(psuInventoryPath);
         psuPathActivationMap.emplace(psuInventoryPath, it->second);
     }
     else
@@ -269,15 +366,12 @@ void ItemUpdater::createPsuObject(const std::string& psuInventoryPath,
             std::make_tuple(ACTIVATION_FWD_ASSOCIATION,
                             ACTIVATION_REV_ASSOCIATION, psuInventoryPath));
 
-        auto activation = createActivationObject(
-            path, versionId, "", activationState, associations, "");
-        activations.emplace(versionId, std::move(activation));
-        psuPathActivationMap.emplace(psuInventoryPath, activations[versionId]);
-
-        auto versionPtr = createVersionObject(path, versionId, psuVersion,
-                                              VersionPurpose::PSU);
-        versions.emplace(versionId, std::move(versionPtr));
+        auto handle = createSoftware(path, *versionId, Manifest{},
+                                     activationState, associations, "",
+                                     psuVersion);
+        psuPathActivationMap.emplace(psuInventoryPath, handle);
 
+        AssociationBatch batch(*this);
         createActiveAssociation(path);
         addFunctionalAssociation(path);
         addUpdateableAssociation(path);
@@ -293,83 +387,200 @@ void ItemUpdater::removePsuObject(const std::string& psuInventoryPath)
                    psuInventoryPath);
         return;
     }
-    const auto& activationPtr = it->second;
-    psuPathActivationMap.erase(psuInventoryPath);
+    auto handle = it->second;
+    psuPathActivationMap.erase(it);
 
-    auto associations = activationPtr->associations();
-    for (auto iter = associations.begin(); iter != associations.end();)
+    auto* entry = software.find(handle);
+    if (entry == nullptr)
     {
-        if ((std::get<2>(*iter)) == psuInventoryPath)
-        {
-            iter = associations.erase(iter);
-        }
-        else
-        {
-            ++iter;
-        }
+        lg2::error("Stale Activation for PSU {PSUPATH}", "PSUPATH",
+                   psuInventoryPath);
+        return;
     }
-    if (associations.empty())
+    const auto& activation = entry->activation;
+    activation->removePsuAssociation(psuInventoryPath);
+    if (!activation->associations().empty())
+    {
+        return;
+    }
+    if (activation->path().empty())
     {
         // Remove the activation
-        erase(activationPtr->getVersionId());
+        erase(handle);
+        return;
     }
-    else
+
+    // Keep the stored image, the PSUs plugged in later are updated with it
+    removeAssociation(activation->getObjectPath());
+    if (activation->activation() == Activation::Status::Active)
     {
-        // Update association
-        activationPtr->associations(associations);
+        activation->activation(Activation::Status::Ready);
     }
 }
 
 void ItemUpdater::addPsuToStatusMap(const std::string& psuPath)
 {
-    if (!psuStatusMap.contains(psuPath))
+    if (psuCache.find(psuPath) == nullptr)
     {
-        psuStatusMap[psuPath] = {false, ""};
+        // The changes of the Present property are handled from now on
+        psuCache.track(psuPath);
+        psuInterfacePaths.insert(psuPath);
+    }
+}
 
-        // Add PropertiesChanged listener for Item interface so we are notified
-        // when Present property changes
-        psuMatches.emplace_back(
-            bus, MatchRules::propertiesChanged(psuPath, ITEM_IFACE),
-            std::bind(&ItemUpdater::onPsuInventoryChangedMsg, this,
-                      std::placeholders::_1));
+void ItemUpdater::removePsuFromStatusMap(const std::string& psuPath)
+{
+    if (psuPathActivationMap.contains(psuPath))
+    {
+        removePsuObject(psuPath);
     }
+    psuCache.untrack(psuPath);
 }
 
 void ItemUpdater::handlePSUPresenceChanged(const std::string& psuPath)
 {
-    if (psuStatusMap.contains(psuPath))
+    changedPsuPaths.insert(psuPath);
+    presenceDebouncer.schedule();
+}
+
+void ItemUpdater::handlePSUPresenceChanges()
+{
+    std::vector<std::string> presentPaths;
+    for (const auto& psuPath : std::exchange(changedPsuPaths, {}))
     {
-        if (psuStatusMap[psuPath].present)
+        const auto* entry = psuCache.find(psuPath);
+        if (entry == nullptr)
         {
-            // PSU is now present
-            psuStatusMap[psuPath].model = utils::getModel(psuPath);
-            auto version = utils::getVersion(psuPath);
-            if (!version.empty() && !psuPathActivationMap.contains(psuPath))
-            {
-                createPsuObject(psuPath, version);
-            }
+            // Removed from the inventory in the meantime
+            continue;
         }
-        else
+        if (entry->present)
+        {
+            presentPaths.push_back(psuPath);
+        }
+        else if (psuPathActivationMap.contains(psuPath))
         {
             // PSU is now missing
-            psuStatusMap[psuPath].model.clear();
-            if (psuPathActivationMap.contains(psuPath))
-            {
-                removePsuObject(psuPath);
-            }
+            removePsuObject(psuPath);
+        }
+    }
+    if (presentPaths.empty())
+    {
+        return;
+    }
+
+    probePSUs(presentPaths, [this, presentPaths]() {
+        // The stored images are only found once the model of a PSU is known
+        if (scannedModel.empty())
+        {
+            processStoredImage();
+        }
+        for (const auto& psuPath : presentPaths)
+        {
+            syncPsuToLatestImage(psuPath);
+        }
+    });
+}
+
+void ItemUpdater::probePSUs(const std::vector<std::string>& psuPaths,
+                            Callback callback)
+{
+    // Only run the vendor tools for the PSUs that are not cached
+    std::vector<std::string> uncachedPaths;
+    for (const auto& psuPath : psuPaths)
+    {
+        auto model = psuCache.getModel(psuPath);
+        auto version = psuCache.getVersion(psuPath);
+        if (model && version)
+        {
+            onPSUProbed(psuPath, *model, *version);
+        }
+        else
+        {
+            uncachedPaths.push_back(psuPath);
+        }
+    }
+    if (uncachedPaths.empty())
+    {
+        callback();
+        return;
+    }
+
+    // Run the model and version tools concurrently, and handle the PSUs once
+    // both are done
+    struct Probe
+    {
+        std::optional<utils::PathValueMap> models;
+        std::optional<utils::PathValueMap> versions;
+    };
+    auto probe = std::make_shared<Probe>();
+    auto join = [this, probe, uncachedPaths, callback]() {
+        if (!probe->models || !probe->versions)
+        {
+            return;
+        }
+        for (const auto& psuPath : uncachedPaths)
+        {
+            onPSUProbed(psuPath, probe->models->at(psuPath),
+                        probe->versions->at(psuPath));
+        }
+        callback();
+    };
+    utils::getModelsAsync(uncachedPaths,
+                          [probe, join](utils::PathValueMap models) {
+                              probe->models = std::move(models);
+                              join();
+                          });
+    utils::getVersionsAsync(uncachedPaths,
+                            [probe, join](utils::PathValueMap versions) {
+                                probe->versions = std::move(versions);
+                                join();
+                            });
+}
+
+void ItemUpdater::onPSUProbed(const std::string& psuPath,
+                              const std::string& model,
+                              const std::string& version)
+{
+    // The PSU may have been removed while the vendor tools were running
+    const auto* entry = psuCache.find(psuPath);
+    if (entry == nullptr || !entry->present)
+    {
+        return;
+    }
+
+    psuCache.setProbed(psuPath, model, version);
+    if (version.empty())
+    {
+        return;
+    }
+
+    // A PSU swapped within the settle window is still associated with the
+    // version of the PSU it replaced
+    auto it = psuPathActivationMap.find(psuPath);
+    if (it != psuPathActivationMap.end())
+    {
+        const auto* running = software.find(it->second);
+        if (running != nullptr &&
+            running->version->getVersionString() == version)
+        {
+            return;
         }
+        removePsuObject(psuPath);
     }
+    createPsuObject(psuPath, version);
 }
 
 std::unique_ptr<Version> ItemUpdater::createVersionObject(
-    const std::string& objPath, const std::string& versionId,
-    const std::string& versionString,
+    const std::string& objPath, utils::VersionId versionId,
+    utils::SlotHandle handle, const std::string& versionString,
     sdbusplus::xyz::openbmc_project::Software::server::Version::VersionPurpose
         versionPurpose)
 {
-    versionStrings.insert(versionString);
+    versionIds.insert_or_assign(versionString, versionId);
+    versionIdRegistry.insert(versionString, versionId);
     auto version = std::make_unique<Version>(
-        bus, objPath, versionId, versionString, versionPurpose,
+        bus, objPath, versionId, handle, versionString, versionPurpose,
         std::bind(&ItemUpdater::erase, this, std::placeholders::_1));
     return version;
 }
@@ -397,44 +608,90 @@ void ItemUpdater::onPsuInventoryChangedMsg(sdbusplus::message_t& msg)
 void ItemUpdater::onPsuInventoryChanged(const std::string& psuPath,
                                         const Properties& properties)
 {
-    if (psuStatusMap.contains(psuPath) && properties.contains(PRESENT))
+    // The match covers all inventory objects, only the PSUs are handled
+    if (psuCache.find(psuPath) != nullptr && properties.contains(PRESENT))
     {
-        psuStatusMap[psuPath].present = std::get<bool>(properties.at(PRESENT));
+        psuCache.setPresent(psuPath, std::get<bool>(properties.at(PRESENT)));
         handlePSUPresenceChanged(psuPath);
-        if (psuStatusMap[psuPath].present)
-        {
-            // Check if there are new PSU images to update
-            processStoredImage();
-            syncToLatestImage();
-        }
     }
 }
 
-void ItemUpdater::processPSUImage()
+void ItemUpdater::processPSUImage(Callback callback)
 {
-    try
+    std::vector<std::string> presentPaths;
+    std::vector<std::string> paths;
+    bool enumerated = false;
+    if (auto inventory = utils::getPSUInventory(bus))
     {
-        auto paths = utils::getPSUInventoryPaths(bus);
-        for (const auto& p : paths)
+        enumerated = true;
+        // The snapshot of the inventory has the presence of the PSUs
+        for (const auto& [p, psu] : *inventory)
         {
-            try
+            addPsuToStatusMap(p);
+            psuCache.setInventory(p, psu);
+            if (!psu.present)
             {
-                addPsuToStatusMap(p);
-                auto service = utils::getService(bus, p.c_str(), ITEM_IFACE);
-                psuStatusMap[p].present = utils::getProperty<bool>(
-                    bus, service.c_str(), p.c_str(), ITEM_IFACE, PRESENT);
-                handlePSUPresenceChanged(p);
+                paths.push_back(p);
             }
-            catch (const std::exception& e)
+            else if (*psu.present)
             {
-                // Ignore errors; the information might not be available yet
+                presentPaths.push_back(p);
             }
         }
     }
-    catch (const std::exception& e)
+    else
     {
-        // Ignore errors; the information might not be available yet
+        try
+        {
+            paths = utils::getPSUInventoryPaths(bus);
+            for (const auto& p : paths)
+            {
+                addPsuToStatusMap(p);
+            }
+            enumerated = true;
+        }
+        catch (const std::exception& e)
+        {
+            // Ignore errors; the information might not be available yet
+        }
     }
+
+    // Read the presence of the other PSUs object by object, concurrently
+    utils::getPresentAsync(
+        bus, paths,
+        [this, paths, presentPaths, enumerated,
+         callback](utils::PathPresentMap presentMap) mutable {
+            bool complete = enumerated;
+            for (const auto& p : paths)
+            {
+                // The PSUs whose presence is unknown are missing from the map
+                auto it = presentMap.find(p);
+                if (it == presentMap.end())
+                {
+                    complete = false;
+                    continue;
+                }
+                psuCache.setPresent(p, it->second);
+                if (it->second)
+                {
+                    presentPaths.push_back(p);
+                }
+            }
+            // From now on the index is kept current by the inventory signals.
+            // Until the inventory is fully read, which is retried on refresh,
+            // the activations query it.
+            if (complete)
+            {
+                psuCache.markSeeded();
+            }
+            else
+            {
+                lg2::info("Unable to read the whole PSU inventory");
+            }
+
+            // Query the vendor tools for all present PSUs at once
+            probePSUs(presentPaths, callback);
+        });
 }
 
 void ItemUpdater::processStoredImage()
@@ -489,12 +746,14 @@ void ItemUpdater::scanDirectory(const fs::path& dir)
     }
 
     // Get version, extVersion, and model from manifest file
-    auto ret = Version::getValues(
-        manifest.string(), {MANIFEST_VERSION, MANIFEST_EXTENDED_VERSION});
-    auto version = ret[MANIFEST_VERSION];
-    auto extVersion = ret[MANIFEST_EXTENDED_VERSION];
-    auto info = Version::getExtVersionInfo(extVersion);
-    auto model = info["model"];
+    auto parsed = Manifest::read(manifest);
+    if (!parsed)
+    {
+        throw std::runtime_error{
+            std::format("Unable to read manifest: {}", manifest.c_str())};
+    }
+    const auto& version = parsed->version;
+    const auto& model = parsed->model;
 
     // Verify version and model are valid
     if (version.empty() || model.empty())
@@ -516,22 +775,20 @@ void ItemUpdater::scanDirectory(const fs::path& dir)
     lg2::info("Found PSU firmware image directory: {PATH}", "PATH", modelDir);
 
     // Calculate version ID and check if an Activation for it exists
-    auto versionId = utils::getVersionId(version);
-    auto it = activations.find(versionId);
-    if (it == activations.end())
+    auto versionId = versionIdRegistry.resolve(version);
+    if (!versionId)
+    {
+        return;
+    }
+    auto* entry = findSoftware(*versionId);
+    if (entry == nullptr)
     {
         // This is a version that is different than the running PSUs
         auto activationState = Activation::Status::Ready;
-        auto purpose = VersionPurpose::PSU;
-        auto objPath = std::string(SOFTWARE_OBJPATH) + "/" + versionId;
-
-        auto activation = createActivationObject(objPath, versionId, extVersion,
-                                                 activationState, {}, modelDir);
-        activations.emplace(versionId, std::move(activation));
+        auto objPath = std::string(SOFTWARE_OBJPATH) + "/" + versionId->str();
 
-        auto versionPtr =
-            createVersionObject(objPath, versionId, version, purpose);
-        versions.emplace(versionId, std::move(versionPtr));
+        createSoftware(objPath, *versionId, *parsed, activationState, {},
+                       modelDir, version);
     }
     else
     {
@@ -539,8 +796,8 @@ void ItemUpdater::scanDirectory(const fs::path& dir)
         // running on one or more PSUs. Set Path and ExtendedVersion properties.
         // The properties are not set when the Activation is created for code
         // running on a PSU. The properties are needed to update other PSUs.
-        it->second->path(modelDir);
-        it->second->extendedVersion(extVersion);
+        entry->activation->path(modelDir);
+        entry->activation->setManifest(*parsed);
     }
 }
 
@@ -565,16 +822,18 @@ fs::path ItemUpdater::findModelDirectory(const fs::path& dir)
     // Get the model name of the PSUs that have been found.  Note that we
     // might not have found the PSU information yet on D-Bus.
     std::string model;
-    for (const auto& [key, item] : psuStatusMap)
+    for (const auto& [key, item] : psuCache.entries())
     {
-        if (!item.model.empty())
+        if (item.model && !item.model->empty())
         {
-            model = item.model;
+            model = *item.model;
             break;
         }
     }
     if (!model.empty())
     {
+        scannedModel = model;
+
         // Verify model subdirectory path exists and is a directory
         auto subDir = dir / model;
         if (!fs::exists(subDir))
@@ -596,69 +855,76 @@ fs::path ItemUpdater::findModelDirectory(const fs::path& dir)
     return modelDir;
 }
 
-std::optional<std::string> ItemUpdater::getLatestVersionId()
+std::optional<utils::VersionId> ItemUpdater::findVersionId(
+    const std::string& version) const
 {
-    std::string latestVersion;
-    if (ALWAYS_USE_BUILTIN_IMG_DIR)
-    {
-        latestVersion = getFWVersionFromBuiltinDir();
-    }
-    else
+    auto versionId = versionIdRegistry.find(version);
+    if (!versionId)
     {
-        latestVersion = utils::getLatestVersion(versionStrings);
+        lg2::error("Unable to find versionId for latest version {VERSION}",
+                   "VERSION", version);
     }
-    if (latestVersion.empty())
+    return versionId;
+}
+
+void ItemUpdater::syncToLatestImage()
+{
+    if (ALWAYS_USE_BUILTIN_IMG_DIR)
     {
-        return {};
+        syncToVersion(getFWVersionFromBuiltinDir());
+        return;
     }
-
-    std::optional<std::string> versionId;
-    for (const auto& v : versions)
+    if (versionIds.key_comp().scheme() != utils::VersionScheme::util)
     {
-        if (v.second->version() == latestVersion)
+        // The versions are ordered in-process, the latest one is the last
+        if (!versionIds.empty())
         {
-            versionId = v.first;
-            break;
+            syncToVersion(versionIds.rbegin()->first);
         }
+        return;
     }
-    if (!versionId.has_value())
+
+    std::set<std::string> versionStrings;
+    for (const auto& [versionString, versionId] : versionIds)
     {
-        lg2::error("Unable to find versionId for latest version {VERSION}",
-                   "VERSION", latestVersion);
+        versionStrings.insert(versionString);
     }
-    return versionId;
+    utils::getLatestVersionAsync(
+        versionStrings,
+        [this](std::string latestVersion) { syncToVersion(latestVersion); });
 }
 
-void ItemUpdater::syncToLatestImage()
+void ItemUpdater::syncToVersion(const std::string& latestVersion)
 {
-    auto latestVersionId = getLatestVersionId();
+    if (latestVersion.empty())
+    {
+        return;
+    }
+    auto latestVersionId = findVersionId(latestVersion);
     if (!latestVersionId)
     {
         return;
     }
-    const auto& it = activations.find(*latestVersionId);
-    if (it == activations.end())
-
+    auto* entry = findSoftware(*latestVersionId);
+    if (entry == nullptr)
     {
         lg2::error("Unable to find Activation for versionId {VERSION_ID}",
-                   "VERSION_ID", *latestVersionId);
+                   "VERSION_ID", latestVersionId->str());
         return;
     }
-    const auto& activation = it->second;
-    const auto& assocs = activation->associations();
+    const auto& activation = entry->activation;
 
-    auto paths = utils::getPSUInventoryPaths(bus);
-    for (const auto& p : paths)
+    for (const auto& [p, entry] : psuCache.entries())
     {
         // If there is a present PSU that is not associated with the latest
         // image, run the activation so that all PSUs are running the same
         // latest image.
-        if (psuStatusMap.contains(p) && psuStatusMap[p].present)
+        if (entry.present)
         {
-            if (!utils::isAssociated(p, assocs))
+            if (!activation->isAssociated(p))
             {
                 lg2::info("Automatically update PSUs to versionId {VERSION_ID}",
-                          "VERSION_ID", *latestVersionId);
+                          "VERSION_ID", latestVersionId->str());
                 invokeActivation(activation);
                 break;
             }
@@ -666,6 +932,81 @@ void ItemUpdater::syncToLatestImage()
     }
 }
 
+void ItemUpdater::syncPsuToLatestImage(const std::string& psuPath)
+{
+    if (ALWAYS_USE_BUILTIN_IMG_DIR)
+    {
+        syncPsuToVersion(psuPath, getFWVersionFromBuiltinDir());
+        return;
+    }
+
+    // The images that can be installed on the PSU
+    auto model = psuCache.getModel(psuPath).value_or("");
+    std::set<std::string> versionStrings;
+    software.forEach([&](utils::SlotHandle, const Software& entry) {
+        const auto& activation = entry.activation;
+        auto status = activation->activation();
+        if (activation->path().empty() || activation->getModel() != model ||
+            (status != Activation::Status::Ready &&
+             status != Activation::Status::Active))
+        {
+            return;
+        }
+        if (entry.version)
+        {
+            versionStrings.insert(entry.version->getVersionString());
+        }
+    });
+    if (versionStrings.empty())
+    {
+        return;
+    }
+    if (auto psuVersion = psuCache.getVersion(psuPath))
+    {
+        versionStrings.insert(*psuVersion);
+    }
+
+    if (versionIds.key_comp().scheme() != utils::VersionScheme::util)
+    {
+        syncPsuToVersion(psuPath, *std::ranges::max_element(
+                                      versionStrings, versionIds.key_comp()));
+        return;
+    }
+    utils::getLatestVersionAsync(
+        versionStrings, [this, psuPath](std::string latestVersion) {
+            syncPsuToVersion(psuPath, latestVersion);
+        });
+}
+
+void ItemUpdater::syncPsuToVersion(const std::string& psuPath,
+                                   const std::string& latestVersion)
+{
+    // The PSU may have been removed while the version tool was running
+    if (latestVersion.empty() || !isPresent(psuPath))
+    {
+        return;
+    }
+    auto latestVersionId = findVersionId(latestVersion);
+    if (!latestVersionId)
+    {
+        return;
+    }
+    auto* entry = findSoftware(*latestVersionId);
+    if (entry == nullptr)
+    {
+        lg2::error("Unable to find Activation for versionId {VERSION_ID}",
+                   "VERSION_ID", latestVersionId->str());
+        return;
+    }
+    const auto& activation = entry->activation;
+    if (!activation->isAssociated(psuPath))
+    {
+        lg2::info("Automatically update PSU {PSU} to versionId {VERSION_ID}",
+                  "PSU", psuPath, "VERSION_ID", latestVersionId->str());
+        activation->activatePsu(psuPath);
+    }
+}
+
 void ItemUpdater::invokeActivation(
     const std::unique_ptr<Activation>& activation)
 {
@@ -674,10 +1015,6 @@ void ItemUpdater::invokeActivation(
 
 void ItemUpdater::onPSUInterfacesAdded(sdbusplus::message_t& msg)
 {
-    // Maintain static set of valid PSU paths. This is needed if PSU interface
-    // comes in a separate InterfacesAdded message from Item interface.
-    static std::set<std::string> psuPaths{};
-
     try
     {
         sdbusplus::object_path objPath;
@@ -685,26 +1022,22 @@ void ItemUpdater::onPSUInterfacesAdded(sdbusplus::message_t& msg)
         msg.read(objPath, interfaces);
         std::string path = objPath.str;
 
+        // The PSU interface may come in a separate InterfacesAdded message
+        // from the Item interface
         if (interfaces.contains(PSU_INVENTORY_IFACE))
         {
-            psuPaths.insert(path);
+            psuInterfacePaths.insert(path);
         }
 
-        if (interfaces.contains(ITEM_IFACE) && psuPaths.contains(path) &&
-            !psuStatusMap.contains(path))
+        if (interfaces.contains(ITEM_IFACE) &&
+            psuInterfacePaths.contains(path) && psuCache.find(path) == nullptr)
         {
             auto interface = interfaces[ITEM_IFACE];
             if (interface.contains(PRESENT))
             {
                 addPsuToStatusMap(path);
-                psuStatusMap[path].present = std::get<bool>(interface[PRESENT]);
+                psuCache.setPresent(path, std::get<bool>(interface[PRESENT]));
                 handlePSUPresenceChanged(path);
-                if (psuStatusMap[path].present)
-                {
-                    // Check if there are new PSU images to update
-                    processStoredImage();
-                    syncToLatestImage();
-                }
             }
         }
     }
@@ -715,31 +1048,79 @@ void ItemUpdater::onPSUInterfacesAdded(sdbusplus::message_t& msg)
     }
 }
 
+void ItemUpdater::onPSUInterfacesRemovedMsg(sdbusplus::message_t& msg)
+{
+    try
+    {
+        sdbusplus::object_path objPath;
+        std::vector<std::string> interfaces;
+        msg.read(objPath, interfaces);
+        onPSUInterfacesRemoved(objPath.str, interfaces);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error(
+            "Unable to handle inventory InterfacesRemoved event: {ERROR}",
+            "ERROR", e);
+    }
+}
+
+void ItemUpdater::onPSUInterfacesRemoved(
+    const std::string& path, const std::vector<std::string>& interfaces)
+{
+    auto removed = [&interfaces](const char* interface) {
+        return std::ranges::find(interfaces, interface) != interfaces.end();
+    };
+    if (removed(PSU_INVENTORY_IFACE))
+    {
+        psuInterfacePaths.erase(path);
+    }
+    if ((removed(PSU_INVENTORY_IFACE) || removed(ITEM_IFACE)) &&
+        psuCache.find(path) != nullptr)
+    {
+        lg2::info("PSU {PSU} removed from the inventory", "PSU", path);
+        removePsuFromStatusMap(path);
+    }
+}
+
+void ItemUpdater::refresh()
+{
+    psuCache.logStats();
+    psuCache.invalidate();
+    utils::refreshServices();
+    processPSUImageAndSyncToLatest();
+}
+
+bool ItemUpdater::isPresent(const std::string& psuPath) const
+{
+    const auto* entry = psuCache.find(psuPath);
+    return entry != nullptr && entry->present;
+}
+
 void ItemUpdater::processPSUImageAndSyncToLatest()
 {
-    processPSUImage();
-    processStoredImage();
-    syncToLatestImage();
+    processPSUImage([this]() {
+        processStoredImage();
+        syncToLatestImage();
+    });
 }
 
 std::string ItemUpdater::getFWVersionFromBuiltinDir()
 {
-    std::string version;
-    for (const auto& activation : activations)
+    auto builtin = imageSourceIndex.find(ImageSource::builtin);
+    if (builtin == imageSourceIndex.end())
+    {
+        return {};
+    }
+    for (const auto& handle : builtin->second)
     {
-        if (activation.second->path().starts_with(IMG_DIR_BUILTIN))
+        auto* entry = software.find(handle);
+        if (entry != nullptr && entry->version)
         {
-            std::string versionId = activation.second->getVersionId();
-            auto it = versions.find(versionId);
-            if (it != versions.end())
-            {
-                const auto& versionPtr = it->second;
-                version = versionPtr->version();
-                break;
-            }
+            return entry->version->version();
         }
     }
-    return version;
+    return {};
 }
 
 } // namespace updater
@@ -4,18 +4,33 @@
 
 #include "activation.hpp"
 #include "association_interface.hpp"
+#include "association_store.hpp"
+#include "debouncer.hpp"
+#include "interned_path.hpp"
+#include "job_dispatcher.hpp"
+#include "psu_cache.hpp"
+#include "slot_map.hpp"
 #include "types.hpp"
 #include "utils.hpp"
 #include "version.hpp"
+#include "version_compare.hpp"
+#include "version_id.hpp"
+#include "version_id_registry.hpp"
 
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/server.hpp>
 #include <xyz/openbmc_project/Association/Definitions/server.hpp>
 #include <xyz/openbmc_project/Collection/DeleteAll/server.hpp>
 
+#include <chrono>
 #include <filesystem>
+#include <functional>
 #include <map>
+#include <memory>
+#include <optional>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -37,6 +52,18 @@ namespace MatchRules = sdbusplus::match_rules;
 
 namespace fs = std::filesystem;
 
+/** @struct Software
+ *  @brief The D-Bus objects of a software version
+ */
+struct Software
+{
+    /** @brief The Activation D-Bus object */
+    std::unique_ptr<Activation> activation;
+
+    /** @brief The Version D-Bus object */
+    std::unique_ptr<Version> version;
+};
+
 /** @class ItemUpdater
  *  @brief Manages the activation of the PSU version items.
  */
@@ -63,19 +90,33 @@ class ItemUpdater :
         psuInterfaceMatch(
             bus,
             MatchRules::interfacesAdded() +
-                MatchRules::path("/xyz/openbmc_project/inventory") +
-                MatchRules::sender("xyz.openbmc_project.Inventory.Manager"),
+                MatchRules::path(INVENTORY_OBJPATH) +
+                MatchRules::sender(INVENTORY_BUSNAME),
             std::bind(std::mem_fn(&ItemUpdater::onPSUInterfacesAdded), this,
-                      std::placeholders::_1))
+                      std::placeholders::_1)),
+        psuInterfaceRemovedMatch(
+            bus,
+            MatchRules::interfacesRemoved() +
+                MatchRules::path(INVENTORY_OBJPATH) +
+                MatchRules::sender(INVENTORY_BUSNAME),
+            std::bind(std::mem_fn(&ItemUpdater::onPSUInterfacesRemovedMsg),
+                      this, std::placeholders::_1)),
+        psuPresenceMatch(
+            bus,
+            MatchRules::propertiesChangedNamespace(PSU_INVENTORY_PATH_BASE,
+                                                   ITEM_IFACE),
+            std::bind(std::mem_fn(&ItemUpdater::onPsuInventoryChangedMsg),
+                      this, std::placeholders::_1))
     {
+        utils::cacheServices(bus);
         processPSUImageAndSyncToLatest();
     }
 
     /** @brief Deletes version
      *
-     *  @param[in] versionId - Id of the version to delete
+     *  @param[in] handle - The handle of the software to delete
      */
-    void erase(const std::string& versionId);
+    void erase(utils::SlotHandle handle);
 
     /** @brief Creates an active association to the
      *  newly active software image
@@ -104,15 +145,41 @@ class ItemUpdater :
      */
     void removeAssociation(const std::string& path) override;
 
+    /** @brief Defer the emission of the associations until
+     *  commitAssociations() is called as many times
+     */
+    void beginAssociations() override;
+
+    /** @brief Emit the associations changed since the outermost
+     *  beginAssociations() at once
+     */
+    void commitAssociations() override;
+
     /** @brief Notify a PSU is updated
      *
-     * @param[in]  versionId - The versionId of the activation
+     * @param[in]  handle - The handle of the software of the activation
      * @param[in]  psuInventoryPath - The PSU inventory path that is updated
      */
-    void onUpdateDone(const std::string& versionId,
+    void onUpdateDone(utils::SlotHandle handle,
                       const std::string& psuInventoryPath) override;
 
+    /** @brief Index the activation by the source of its new image path
+     *
+     * @param[in]  handle - The handle of the software of the activation
+     * @param[in]  oldPath - The previous image path, or empty
+     * @param[in]  newPath - The new image path, or empty
+     */
+    void onPathChanged(utils::SlotHandle handle, const std::string& oldPath,
+                       const std::string& newPath) override;
+
+    /** @brief Refresh the cached PSU information
+     *  @details Logs the cache statistics, invalidates the PSU and service
+     *           caches and queries the PSUs again.
+     */
+    void refresh();
+
   private:
+    using Callback = std::function<void()>;
     using Properties =
         std::map<std::string, utils::UtilsInterface::PropertyType>;
     using InterfacesAddedMap =
@@ -153,17 +220,45 @@ class ItemUpdater :
 
     /** @brief Create Activation object */
     std::unique_ptr<Activation> createActivationObject(
-        const std::string& path, const std::string& versionId,
-        const std::string& extVersion, Activation::Status activationStatus,
-        const AssociationList& assocs, const std::string& filePath);
+        const std::string& path, utils::VersionId versionId,
+        utils::SlotHandle handle, const Manifest& manifest,
+        Activation::Status activationStatus, const AssociationList& assocs,
+        const std::string& filePath);
 
     /** @brief Create Version object */
     std::unique_ptr<Version> createVersionObject(
-        const std::string& objPath, const std::string& versionId,
-        const std::string& versionString,
+        const std::string& objPath, utils::VersionId versionId,
+        utils::SlotHandle handle, const std::string& versionString,
         sdbusplus::xyz::openbmc_project::Software::server::Version::
             VersionPurpose versionPurpose);
 
+    /** @brief Create the Activation and Version objects of a PSU version
+     *
+     * @param[in] path - The D-Bus object path
+     * @param[in] versionId - The version id
+     * @param[in] manifest - The manifest of the image, empty for the
+     *                       software running on a PSU
+     * @param[in] activationStatus - The status of the Activation
+     * @param[in] assocs - The associations of the Activation
+     * @param[in] filePath - The image filesystem path
+     * @param[in] versionString - The version string
+     *
+     * @return The handle of the software
+     */
+    utils::SlotHandle createSoftware(
+        const std::string& path, utils::VersionId versionId,
+        const Manifest& manifest, Activation::Status activationStatus,
+        const AssociationList& assocs, const std::string& filePath,
+        const std::string& versionString);
+
+    /** @brief Get the software of a version id
+     *
+     * @param[in] versionId - The version id
+     *
+     * @return The software, or nullptr if there is none
+     */
+    Software* findSoftware(utils::VersionId versionId);
+
     /** @brief Create Activation and Version object for PSU inventory
      *  @details If the same version exists for multiple PSUs, just add
      *           related association, instead of creating new objects.
@@ -175,29 +270,77 @@ class ItemUpdater :
      *  @details If the same version exists for multiple PSUs, just remove
      *           related association.
      *           If the version has no association, the Activation and
-     *           Version object will be removed
+     *           Version object will be removed, unless it has a stored image
+     *           to update the PSUs with. It is then kept as Ready.
      */
     void removePsuObject(const std::string& psuInventoryPath);
 
-    /** @brief Add PSU inventory path to the PSU status map
+    /** @brief Add PSU inventory path to the PSU cache
      *  @details Also adds a PropertiesChanged listener for the inventory path
      *           so we are notified when the Present property changes.
-     *           Does nothing if the inventory path already exists in the map.
+     *           Does nothing if the inventory path is already cached.
      *
      * @param[in]  psuPath - The PSU inventory path
      */
     void addPsuToStatusMap(const std::string& psuPath);
 
+    /** @brief Remove PSU inventory path from the PSU cache
+     *  @details Also removes the PSU software object and the PropertiesChanged
+     *           listener of the inventory path.
+     *
+     * @param[in]  psuPath - The PSU inventory path
+     */
+    void removePsuFromStatusMap(const std::string& psuPath);
+
+    /** @brief Whether the PSU is tracked and present
+     *
+     * @param[in]  psuPath - The PSU inventory path
+     */
+    bool isPresent(const std::string& psuPath) const;
+
     /** @brief Handle a change in presence for a PSU.
+     *  @details The changes are coalesced until PSU_EVENT_SETTLE_TIME has
+     *           elapsed, then handled by handlePSUPresenceChanges().
      *
      * @param[in]  psuPath - The PSU inventory path
      */
     void handlePSUPresenceChanged(const std::string& psuPath);
 
+    /** @brief Handle the PSU presence changes of a burst of events.
+     *  @details The software objects of the missing PSUs are removed, the
+     *           present PSUs are probed together, then each of them is synced
+     *           to the latest image for its model.
+     */
+    void handlePSUPresenceChanges();
+
+    /** @brief Handle the model and version obtained for a present PSU.
+     *
+     * @param[in]  psuPath - The PSU inventory path
+     * @param[in]  model - The PSU model
+     * @param[in]  version - The PSU firmware version
+     */
+    void onPSUProbed(const std::string& psuPath, const std::string& model,
+                     const std::string& version);
+
+    /** @brief Get the model and version of the present PSUs.
+     *  @details The model and version tools are invoked concurrently and
+     *           asynchronously, in batch mode if they support it, and
+     *           onPSUProbed() is called for each PSU once both are done.
+     *
+     * @param[in]  psuPaths - The present PSU inventory paths
+     * @param[in]  callback - Invoked once all PSUs have been handled
+     */
+    void probePSUs(const std::vector<std::string>& psuPaths,
+                   Callback callback);
+
     /**
      * @brief Create and populate the active PSU Version.
+     * @details The presence of the PSUs is read from a snapshot of the
+     *          inventory if available, and the PSUs are probed concurrently.
+     *
+     * @param[in]  callback - Invoked once all PSUs have been handled
      */
-    void processPSUImage();
+    void processPSUImage(Callback callback);
 
     /** @brief Create PSU Version from stored images */
     void processStoredImage();
@@ -218,12 +361,40 @@ class ItemUpdater :
      */
     fs::path findModelDirectory(const fs::path& dir);
 
-    /** @brief Get the versionId of the latest PSU version */
-    std::optional<std::string> getLatestVersionId();
+    /** @brief Get the versionId of the specified PSU version
+     *
+     * @param[in] version - The PSU version string
+     */
+    std::optional<utils::VersionId> findVersionId(
+        const std::string& version) const;
 
     /** @brief Update PSUs to the latest version */
     void syncToLatestImage();
 
+    /** @brief Update PSUs to the specified version
+     *
+     * @param[in] latestVersion - The latest PSU version string
+     */
+    void syncToVersion(const std::string& latestVersion);
+
+    /** @brief Update a PSU that was plugged in to the latest image for its
+     *         model, if it runs an older version
+     *  @details Only the Ready and Active activations with an image are
+     *           compared, so the image directories are not scanned again and
+     *           the other PSUs are left alone.
+     *
+     * @param[in] psuPath - The PSU inventory path
+     */
+    void syncPsuToLatestImage(const std::string& psuPath);
+
+    /** @brief Update a PSU to the specified version, if it is not running it
+     *
+     * @param[in] psuPath - The PSU inventory path
+     * @param[in] latestVersion - The latest PSU version string
+     */
+    void syncPsuToVersion(const std::string& psuPath,
+                          const std::string& latestVersion);
+
     /** @brief Invoke the activation via DBus */
     static void invokeActivation(const std::unique_ptr<Activation>& activation);
 
@@ -236,6 +407,23 @@ class ItemUpdater :
      */
     void onPSUInterfacesAdded(sdbusplus::message_t& msg);
 
+    /** @brief Callback function for interfaces removed signal.
+     *
+     *  @param[in] msg - Data associated with subscribed signal
+     */
+    void onPSUInterfacesRemovedMsg(sdbusplus::message_t& msg);
+
+    /** @brief Called when interfaces are removed from an inventory object
+     *  @details Removes the PSU from the internal status map, and its
+     *           software object, if it is no longer a PSU or has no Item
+     *           interface.
+     *
+     * @param[in]  path       - D-Bus object path
+     * @param[in]  interfaces - D-Bus interfaces that were removed
+     */
+    void onPSUInterfacesRemoved(const std::string& path,
+                                const std::vector<std::string>& interfaces);
+
     /**
      * @brief Handles the processing of PSU images.
      *
@@ -245,56 +433,94 @@ class ItemUpdater :
      */
     void processPSUImageAndSyncToLatest();
 
+    /** @brief Emit the associations if they changed, unless a batch is
+     *  open
+     */
+    void emitAssociations();
+
     /** @brief Retrieve FW version from IMG_DIR_BUILTIN
      *
      * This function retrieves the firmware version from the PSU model directory
-     * that is in the IMG_DIR_BUILTIN. It loops through the activations map to
-     * find matching path starts with IMG_DIR_BUILTIN, then gets the
-     * corresponding version ID, and then looks it up in the versions map to
-     * retrieve the associated version string.
+     * that is in the IMG_DIR_BUILTIN. It loops through the software to find
+     * the activation whose path starts with IMG_DIR_BUILTIN, and retrieves
+     * the version string of its version object.
      */
     std::string getFWVersionFromBuiltinDir();
 
     /** @brief Persistent sdbusplus D-Bus bus connection. */
     sdbusplus::bus_t& bus;
 
-    /** @brief Persistent map of Activation D-Bus objects and their
-     * version id */
-    std::map<std::string, std::unique_ptr<Activation>> activations;
+    /** @brief The dispatcher of the systemd jobs of the PSU update units,
+     * shared with the Activations. It outlives them. */
+    utils::JobDispatcher jobDispatcher{bus};
+
+    /** @brief Persistent table of the Activation and Version D-Bus objects of
+     * the versions, referred to by handle */
+    utils::SlotMap<Software> software;
 
-    /** @brief Persistent map of Version D-Bus objects and their
-     * version id */
-    std::map<std::string, std::unique_ptr<Version>> versions;
+    /** @brief The map of the version ids and the handles of their software */
+    std::unordered_map<utils::VersionId, utils::SlotHandle> softwareIds;
 
-    /** @brief The reference map of PSU Inventory objects and the
-     * Activation*/
-    std::map<std::string, const std::unique_ptr<Activation>&>
+    /** @brief The map of PSU Inventory objects and the handles of the
+     * software of their Activation */
+    std::map<utils::InternedPath, utils::SlotHandle, std::less<>>
         psuPathActivationMap;
 
     /** @brief sdbusplus signal match for PSU Software*/
     sdbusplus::match versionMatch;
 
-    /** @brief sdbusplus signal matches for PSU Inventory */
-    std::vector<sdbusplus::match> psuMatches;
+    /** @brief The inventory paths known to implement the PowerSupply
+     * interface */
+    std::set<std::string> psuInterfacePaths;
+
+    /** @brief The PSU model whose stored images have been scanned */
+    std::string scannedModel;
+
+    /** @brief The PSUs whose presence changed in the current burst of events
+     */
+    std::set<std::string> changedPsuPaths;
+
+    /** @brief Coalesces the PSU presence changes */
+    utils::Debouncer presenceDebouncer{
+        bus.get_event(), std::chrono::milliseconds(PSU_EVENT_SETTLE_TIME),
+        [this]() { handlePSUPresenceChanges(); }};
 
     /** @brief This entry's associations */
-    AssociationList assocs;
+    AssociationStore assocs;
+
+    /** @brief The depth of the nested association batches */
+    unsigned associationBatchDepth{0};
 
-    /** @brief A collection of the version strings */
-    std::set<std::string> versionStrings;
+    /** @brief The map of the version strings and their version ids, ordered
+     * from the oldest to the latest version */
+    std::map<std::string, utils::VersionId, utils::VersionCompare> versionIds{
+        utils::VersionCompare::fromConfig()};
 
-    /** @brief A struct to hold the PSU present status and model */
-    struct psuStatus
+    /** @brief The version ids of the software, which resolves the
+     * collisions of the ids of the versions */
+    utils::VersionIdRegistry versionIdRegistry;
+
+    /** @brief The sources of the images */
+    enum class ImageSource
     {
-        bool present;
-        std::string model;
+        builtin,
+        persist,
+        tmp,
     };
 
-    /** @brief The map of PSU inventory path and the psuStatus
+    /** @brief Get the source of an image path, if it is in an image dir */
+    static std::optional<ImageSource> getImageSource(const std::string& path);
+
+    /** @brief The handles of the software of the activations, by the source
+     * of their image */
+    std::map<ImageSource, std::set<utils::SlotHandle>> imageSourceIndex;
+
+    /** @brief The cache of the PSU present status, model and version
      *
      * It is used to handle psu inventory changed event, that only create psu
-     * software object when a PSU is present and the model is retrieved */
-    std::map<std::string, psuStatus> psuStatusMap;
+     * software object when a PSU is present and the model is retrieved. It is
+     * shared with the Activations. */
+    PsuCache psuCache{bus};
 
     /** @brief Signal match for PSU interfaces added.
      *
@@ -303,6 +529,22 @@ class ItemUpdater :
      * `onInterfacesAdded` method to handle the new PSU.
      */
     sdbusplus::match psuInterfaceMatch;
+
+    /** @brief Signal match for PSU interfaces removed.
+     *
+     * This match listens for D-Bus signals indicating interfaces have been
+     * removed, to keep the index of the PSU inventory current.
+     */
+    sdbusplus::match psuInterfaceRemovedMatch;
+
+    /** @brief Signal match for the Item properties of the PSUs.
+     *
+     * A single match covers all the inventory objects under
+     * PSU_INVENTORY_PATH_BASE, and the signals are dispatched by path to the
+     * PSUs in the status map, so the number of match rules does not grow with
+     * the number of PSUs.
+     */
+    sdbusplus::match psuPresenceMatch;
 };
 
 } // namespace updater
@@ -0,0 +1,68 @@
+#include "config.h"
+
+#include "job_dispatcher.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+namespace utils
+{
+
+namespace rules = sdbusplus::bus::match::rules;
+
+void JobDispatcher::watch(const std::string& unit, Callback callback)
+{
+    // The unit name is the third argument of JobRemoved
+    auto rule = rules::type::signal() + rules::member("JobRemoved") +
+                rules::path("/org/freedesktop/systemd1") +
+                rules::interface("org.freedesktop.systemd1.Manager") +
+                rules::argN(2, unit);
+    watches.insert_or_assign(
+        unit, Watch{sdbusplus::match(bus, rule,
+                                     [this](sdbusplus::message_t& msg) {
+                                         onJobRemoved(msg);
+                                     }),
+                    std::move(callback)});
+}
+
+void JobDispatcher::unwatch(const std::string& unit)
+{
+    watches.erase(unit);
+}
+
+void JobDispatcher::dispatch(const std::string& unit,
+                             const std::string& result)
+{
+    auto it = watches.find(unit);
+    if (it == watches.end())
+    {
+        return;
+    }
+    // The watcher may stop watching the unit from the callback
+    auto callback = it->second.callback;
+    callback(result);
+}
+
+void JobDispatcher::onJobRemoved(sdbusplus::message_t& msg)
+{
+    uint32_t id{};
+    sdbusplus::object_path job;
+    std::string unit;
+    std::string result;
+
+    try
+    {
+        msg.read(id, job, unit, result);
+        dispatch(unit, result);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Unable to handle unit state change event: {ERROR}", "ERROR",
+                   e);
+    }
+}
+
+} // namespace utils
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <sdbusplus/bus/match.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+
+namespace utils
+{
+
+/** @class JobDispatcher
+ *  @brief Dispatches the systemd JobRemoved signals to the watchers of the
+ *         units.
+ *  @details A signal match is only registered while a unit is watched, and it
+ *           is filtered on the unit name, so the jobs of the other units are
+ *           dropped by the bus instead of waking up the service.
+ */
+class JobDispatcher
+{
+  public:
+    /** @brief The callback with the result of a job of the unit, e.g. "done"
+     *         or "failed" */
+    using Callback = std::function<void(const std::string& result)>;
+
+    JobDispatcher() = delete;
+    JobDispatcher(const JobDispatcher&) = delete;
+    JobDispatcher& operator=(const JobDispatcher&) = delete;
+    JobDispatcher(JobDispatcher&&) = delete;
+    JobDispatcher& operator=(JobDispatcher&&) = delete;
+    ~JobDispatcher() = default;
+
+    /** @brief Constructs JobDispatcher
+     *
+     * @param[in] bus - The D-Bus bus object
+     */
+    explicit JobDispatcher(sdbusplus::bus_t& bus) : bus(bus) {}
+
+    /** @brief Watch the jobs of the unit until unwatch() is called
+     *  @details Replaces the previous watcher of the unit, if any.
+     *
+     * @param[in] unit - The systemd unit name
+     * @param[in] callback - The callback with the result of each job
+     */
+    void watch(const std::string& unit, Callback callback);
+
+    /** @brief Stop watching the jobs of the unit */
+    void unwatch(const std::string& unit);
+
+    /** @brief Dispatch the result of a job to the watcher of the unit
+     *
+     * @param[in] unit - The systemd unit name
+     * @param[in] result - The result of the job
+     */
+    void dispatch(const std::string& unit, const std::string& result);
+
+    /** @brief The number of watched units */
+    size_t watching() const
+    {
+        return watches.size();
+    }
+
+  private:
+    /** @brief Handle a JobRemoved signal */
+    void onJobRemoved(sdbusplus::message_t& msg);
+
+    /** @brief The signal match and the callback of a watched unit */
+    struct Watch
+    {
+        sdbusplus::match match;
+        Callback callback;
+    };
+
+    /** @brief The D-Bus bus object */
+    sdbusplus::bus_t& bus;
+
+    /** @brief The watches, by unit name */
+    std::map<std::string, Watch> watches;
+};
+
+} // namespace utils
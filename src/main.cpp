@@ -2,16 +2,33 @@
 
 #include "item_updater.hpp"
 
+#include <systemd/sd-event.h>
+
+#include <phosphor-logging/lg2.hpp>
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/server/manager.hpp>
 
+#include <csignal>
+#include <cstring>
 #include <system_error>
 
 int main(int /* argc */, char* /* argv */[])
 {
     auto bus = sdbusplus::bus::new_default();
 
+    // The vendor tools are run asynchronously from the default event loop, so
+    // attach the bus to it to keep serving D-Bus while they are running.
+    sd_event* event = nullptr;
+    auto rc = sd_event_default(&event);
+    if (rc < 0)
+    {
+        lg2::error("Unable to get default event loop: {ERROR}", "ERROR",
+                   std::strerror(-rc));
+        return -1;
+    }
+    bus.attach_event(event, SD_EVENT_PRIORITY_NORMAL);
+
     // Add sdbusplus ObjectManager.
     sdbusplus::server::manager_t objManager(bus, SOFTWARE_OBJPATH);
 
@@ -19,10 +36,26 @@ int main(int /* argc */, char* /* argv */[])
 
     bus.request_name(BUSNAME_UPDATER);
 
-    while (true)
+    // SIGHUP refreshes the cached PSU information
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGHUP);
+    sigprocmask(SIG_BLOCK, &mask, nullptr);
+    rc = sd_event_add_signal(
+        event, nullptr, SIGHUP,
+        [](sd_event_source*, const signalfd_siginfo*, void* userdata) {
+            static_cast<phosphor::software::updater::ItemUpdater*>(userdata)
+                ->refresh();
+            return 0;
+        },
+        &updater);
+    if (rc < 0)
     {
-        bus.process_discard();
-        bus.wait();
+        lg2::error("Unable to handle SIGHUP: {ERROR}", "ERROR",
+                   std::strerror(-rc));
     }
-    return 0;
+
+    rc = sd_event_loop(event);
+    sd_event_unref(event);
+    return rc;
 }
@@ -0,0 +1,92 @@
+#include "config.h"
+
+#include "manifest.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cstdint>
+#include <fstream>
+
+namespace phosphor
+{
+namespace software
+{
+namespace updater
+{
+
+namespace
+{
+constexpr std::string_view MANIFEST_PURPOSE = "purpose";
+constexpr std::string_view MANIFEST_VERSION = "version";
+constexpr std::string_view MANIFEST_EXTENDED_VERSION = "extended_version";
+
+using Values = std::map<std::string_view, std::string_view>;
+
+/** @brief Get the first value of each key of the items */
+Values getValues(std::string_view text, char separator)
+{
+    Values values;
+    forEachKeyValue(text, separator,
+                    [&values](std::string_view key, std::string_view value) {
+                        values.emplace(key, value);
+                    });
+    return values;
+}
+
+/** @brief Remove the value of the key from the values and return it */
+std::string take(Values& values, std::string_view key)
+{
+    auto node = values.extract(key);
+    return node ? std::string(node.mapped()) : std::string();
+}
+} // namespace
+
+Manifest Manifest::parse(std::string_view content)
+{
+    Manifest manifest;
+    auto values = getValues(content, '\n');
+    manifest.purpose = take(values, MANIFEST_PURPOSE);
+    manifest.version = take(values, MANIFEST_VERSION);
+    manifest.extendedVersion = take(values, MANIFEST_EXTENDED_VERSION);
+    manifest.otherKeys.insert(values.begin(), values.end());
+
+    auto info = getValues(manifest.extendedVersion, ',');
+    manifest.model = take(info, "model");
+    manifest.manufacturer = take(info, "manufacturer");
+    return manifest;
+}
+
+std::optional<Manifest> Manifest::read(const std::string& filePath)
+{
+    if (filePath.empty())
+    {
+        lg2::error("Error filePath is empty");
+        return std::nullopt;
+    }
+
+    // The file is read at once, and tokenized in place
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        return std::nullopt;
+    }
+    auto size = file.tellg();
+    if (size < 0 || static_cast<size_t>(size) > maxSize)
+    {
+        lg2::error("Invalid size of manifest {PATH}: {SIZE}", "PATH",
+                   filePath, "SIZE", static_cast<int64_t>(size));
+        return std::nullopt;
+    }
+    std::string content(static_cast<size_t>(size), '\0');
+    file.seekg(0);
+    if (!file.read(content.data(), size))
+    {
+        lg2::error("Failed to read manifest {PATH}", "PATH", filePath);
+        return std::nullopt;
+    }
+    return parse(content);
+}
+
+} // namespace updater
+} // namespace software
+} // namespace phosphor
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace phosphor
+{
+namespace software
+{
+namespace updater
+{
+
+/** @brief Call a function with the key and value of each key=value item
+ *  @details The items are separated by the separator, and a trailing \r is
+ *           removed from each of them. The items without '=' are skipped.
+ *           The key and value are views into the text.
+ *
+ * @param[in] text - The items
+ * @param[in] separator - The separator of the items
+ * @param[in] func - Called with the key and value of each item
+ */
+template <typename F>
+void forEachKeyValue(std::string_view text, char separator, F&& func)
+{
+    while (!text.empty())
+    {
+        auto end = text.find(separator);
+        auto item = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size()
+                                                         : end + 1);
+        if (!item.empty() && item.back() == '\r')
+        {
+            item.remove_suffix(1);
+        }
+        auto pos = item.find('=');
+        if (pos != std::string_view::npos)
+        {
+            func(item.substr(0, pos), item.substr(pos + 1));
+        }
+    }
+}
+
+/** @struct Manifest
+ *  @brief The content of the MANIFEST file of a PSU image.
+ *  @details The file has a key=value pair per line. If a key is repeated,
+ *           the first value is kept.
+ */
+struct Manifest
+{
+    /** @brief The maximum size of the file */
+    static constexpr size_t maxSize = 64 * 1024;
+
+    /** @brief The version purpose */
+    std::string purpose;
+
+    /** @brief The version string */
+    std::string version;
+
+    /** @brief The extended version, as comma separated key=value pairs */
+    std::string extendedVersion;
+
+    /** @brief The PSU model, from the extended version */
+    std::string model;
+
+    /** @brief The PSU manufacturer, from the extended version */
+    std::string manufacturer;
+
+    /** @brief The other keys and their values */
+    std::map<std::string, std::string, std::less<>> otherKeys;
+
+    /** @brief Parse the content of a manifest
+     *
+     * @param[in] content - The content of the file
+     *
+     * @return The manifest
+     */
+    static Manifest parse(std::string_view content);
+
+    /** @brief Read and parse a manifest file
+     *
+     * @param[in] filePath - The path of the file
+     *
+     * @return The manifest, or nullopt if the file cannot be read or is
+     *         larger than maxSize
+     */
+    static std::optional<Manifest> read(const std::string& filePath);
+};
+
+} // namespace updater
+} // namespace software
+} // namespace phosphor
@@ -0,0 +1,166 @@
+#include "plugin.hpp"
+
+#include <dlfcn.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <array>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+namespace utils
+{
+
+namespace // anonymous
+{
+/** @brief The size of the buffer for the values returned by the plugin */
+constexpr size_t VALUE_SIZE = 1024;
+
+using Value = std::array<char, VALUE_SIZE>;
+
+/** @brief Convert the value returned by the plugin */
+std::string toString(int rc, const Value& value)
+{
+    if (rc != 0)
+    {
+        return {};
+    }
+    return {value.data(), strnlen(value.data(), value.size())};
+}
+} // namespace
+
+PluginUtils::PluginUtils(const std::string& path) :
+    handle(dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL), &dlclose)
+{
+    if (!handle)
+    {
+        throw std::runtime_error{
+            std::format("Unable to load PSU plugin {}: {}", path, dlerror())};
+    }
+
+    using GetOps = const psu_plugin_ops* (*)();
+    auto getOps =
+        reinterpret_cast<GetOps>(dlsym(handle.get(), PSU_PLUGIN_GET_OPS));
+    if (getOps != nullptr)
+    {
+        ops = getOps();
+    }
+    if (ops == nullptr)
+    {
+        throw std::runtime_error{std::format(
+            "PSU plugin {} does not provide {}", path, PSU_PLUGIN_GET_OPS)};
+    }
+    if (ops->abi_version != PSU_PLUGIN_ABI_VERSION)
+    {
+        throw std::runtime_error{std::format(
+            "PSU plugin {} implements ABI version {}, expected {}", path,
+            ops->abi_version, PSU_PLUGIN_ABI_VERSION)};
+    }
+    if (ops->get_version == nullptr || ops->get_model == nullptr ||
+        ops->compare_versions == nullptr)
+    {
+        throw std::runtime_error{
+            std::format("PSU plugin {} is missing required operations", path)};
+    }
+    lg2::info("Loaded PSU plugin {PATH}", "PATH", path);
+}
+
+std::string PluginUtils::getVersion(const std::string& inventoryPath) const
+{
+    Value value{};
+    auto rc = ops->get_version(inventoryPath.c_str(), value.data(),
+                               value.size());
+    if (rc != 0)
+    {
+        lg2::error("Unable to get firmware version for PSU {PSU}: {RC}", "PSU",
+                   inventoryPath, "RC", rc);
+    }
+    return toString(rc, value);
+}
+
+std::string PluginUtils::getModel(const std::string& inventoryPath) const
+{
+    Value value{};
+    auto rc = ops->get_model(inventoryPath.c_str(), value.data(),
+                             value.size());
+    if (rc != 0)
+    {
+        lg2::error("Unable to get model for PSU {PSU}: {RC}", "PSU",
+                   inventoryPath, "RC", rc);
+    }
+    return toString(rc, value);
+}
+
+std::string PluginUtils::getLatestVersion(
+    const std::set<std::string>& versions) const
+{
+    if (versions.empty())
+    {
+        return {};
+    }
+
+    std::vector<const char*> args;
+    args.reserve(versions.size());
+    for (const auto& version : versions)
+    {
+        args.push_back(version.c_str());
+    }
+
+    Value value{};
+    auto rc = ops->compare_versions(args.data(), args.size(), value.data(),
+                                    value.size());
+    if (rc != 0)
+    {
+        lg2::error("Unable to get latest PSU firmware version: {RC}", "RC",
+                   rc);
+    }
+    return toString(rc, value);
+}
+
+// The plugin is called in-process, so the asynchronous variants complete
+// immediately.
+void PluginUtils::getVersionAsync(const std::string& inventoryPath,
+                                  StringCallback callback) const
+{
+    callback(getVersion(inventoryPath));
+}
+
+void PluginUtils::getModelAsync(const std::string& inventoryPath,
+                                StringCallback callback) const
+{
+    callback(getModel(inventoryPath));
+}
+
+void PluginUtils::getLatestVersionAsync(const std::set<std::string>& versions,
+                                        StringCallback callback) const
+{
+    callback(getLatestVersion(versions));
+}
+
+PathValueMap PluginUtils::getVersions(
+    const std::vector<std::string>& inventoryPaths) const
+{
+    return UtilsInterface::getVersions(inventoryPaths);
+}
+
+PathValueMap PluginUtils::getModels(
+    const std::vector<std::string>& inventoryPaths) const
+{
+    return UtilsInterface::getModels(inventoryPaths);
+}
+
+void PluginUtils::getVersionsAsync(
+    const std::vector<std::string>& inventoryPaths,
+    PathValueCallback callback) const
+{
+    callback(getVersions(inventoryPaths));
+}
+
+void PluginUtils::getModelsAsync(const std::vector<std::string>& inventoryPaths,
+                                 PathValueCallback callback) const
+{
+    callback(getModels(inventoryPaths));
+}
+
+} // namespace utils
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "psu_plugin.h"
+#include "utils.hpp"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace utils
+{
+
+/** @class PluginUtils
+ *  @brief Gets the PSU versions and models from a vendor plugin.
+ *  @details The plugin is a shared object implementing the ABI defined in
+ *           psu_plugin.h, and is called directly instead of running the
+ *           PSU_*_UTIL tools.
+ */
+class PluginUtils : public Utils
+{
+  public:
+    /** @brief Constructs PluginUtils
+     *  @details Loads the plugin; throws an exception if it cannot be loaded
+     *           or does not implement a compatible ABI.
+     *
+     * @param[in] path - The path of the plugin shared object
+     */
+    explicit PluginUtils(const std::string& path);
+
+    std::string getVersion(const std::string& inventoryPath) const override;
+
+    std::string getModel(const std::string& inventoryPath) const override;
+
+    std::string getLatestVersion(
+        const std::set<std::string>& versions) const override;
+
+    void getVersionAsync(const std::string& inventoryPath,
+                         StringCallback callback) const override;
+
+    void getModelAsync(const std::string& inventoryPath,
+                       StringCallback callback) const override;
+
+    void getLatestVersionAsync(const std::set<std::string>& versions,
+                               StringCallback callback) const override;
+
+    PathValueMap getVersions(
+        const std::vector<std::string>& inventoryPaths) const override;
+
+    PathValueMap getModels(
+        const std::vector<std::string>& inventoryPaths) const override;
+
+    void getVersionsAsync(const std::vector<std::string>& inventoryPaths,
+                          PathValueCallback callback) const override;
+
+    void getModelsAsync(const std::vector<std::string>& inventoryPaths,
+                        PathValueCallback callback) const override;
+
+  private:
+    /** @brief The dlopen() handle of the plugin */
+    std::unique_ptr<void, int (*)(void*)> handle;
+
+    /** @brief The operations of the plugin */
+    const psu_plugin_ops* ops{nullptr};
+};
+
+} // namespace utils
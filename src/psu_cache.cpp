@@ -0,0 +1,212 @@
+#include "config.h"
+
+#include "psu_cache.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+namespace phosphor
+{
+namespace software
+{
+namespace updater
+{
+
+namespace // anonymous
+{
+/** @brief Clear the cached attributes of a PSU */
+void clear(PsuCache::Entry& entry)
+{
+    entry.model.reset();
+    entry.version.reset();
+    entry.manufacturer.reset();
+}
+} // namespace
+
+const PsuCache::Entry* PsuCache::find(const std::string& psuPath) const
+{
+    auto it = cache.find(psuPath);
+    return it == cache.end() ? nullptr : &it->second;
+}
+
+PsuCache::Entry* PsuCache::findPresent(const std::string& psuPath)
+{
+    auto it = cache.find(psuPath);
+    if (it == cache.end() || !it->second.present)
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+template <typename T>
+std::optional<T> PsuCache::count(const std::optional<T>& value)
+{
+    ++(value ? hitCount : missCount);
+    return value;
+}
+
+void PsuCache::track(const std::string& psuPath)
+{
+    cache.try_emplace(utils::InternedPath(psuPath));
+}
+
+void PsuCache::untrack(const std::string& psuPath)
+{
+    auto it = cache.find(psuPath);
+    if (it != cache.end())
+    {
+        cache.erase(it);
+    }
+}
+
+void PsuCache::setPresent(const std::string& psuPath, bool present)
+{
+    auto it = cache.find(psuPath);
+    if (it == cache.end() || it->second.present == present)
+    {
+        return;
+    }
+    // The PSU was added or removed, so its attributes may have changed
+    clear(it->second);
+    it->second.present = present;
+}
+
+void PsuCache::setProbed(const std::string& psuPath, const std::string& model,
+                         const std::string& version)
+{
+    // Failures to get the values are not cached, so they are retried
+    auto* entry = findPresent(psuPath);
+    if (entry == nullptr)
+    {
+        return;
+    }
+    if (!model.empty())
+    {
+        entry->model = model;
+    }
+    if (!version.empty())
+    {
+        entry->version = version;
+    }
+}
+
+void PsuCache::setInventory(const std::string& psuPath,
+                            const utils::PsuInventory& psu)
+{
+    if (psu.present)
+    {
+        setPresent(psuPath, *psu.present);
+    }
+    auto* entry = findPresent(psuPath);
+    if (entry != nullptr && psu.manufacturer)
+    {
+        entry->manufacturer = psu.manufacturer;
+    }
+}
+
+bool PsuCache::isPresent(const std::string& psuPath)
+{
+    if (const auto* entry = find(psuPath))
+    {
+        ++hitCount;
+        return entry->present;
+    }
+    ++missCount;
+    auto service = utils::getService(bus, psuPath.c_str(), ITEM_IFACE);
+    return utils::getProperty<bool>(bus, service.c_str(), psuPath.c_str(),
+                                    ITEM_IFACE, PRESENT);
+}
+
+std::string PsuCache::getManufacturer(const std::string& psuPath)
+{
+    auto* entry = findPresent(psuPath);
+    if (entry != nullptr && entry->manufacturer)
+    {
+        ++hitCount;
+        return *entry->manufacturer;
+    }
+    ++missCount;
+    auto service = utils::getService(bus, psuPath.c_str(), ASSET_IFACE);
+    auto manufacturer = utils::getProperty<std::string>(
+        bus, service.c_str(), psuPath.c_str(), ASSET_IFACE, MANUFACTURER);
+    if (entry != nullptr)
+    {
+        entry->manufacturer = manufacturer;
+    }
+    return manufacturer;
+}
+
+std::optional<std::string> PsuCache::getModel(const std::string& psuPath)
+{
+    const auto* entry = findPresent(psuPath);
+    return count(entry != nullptr ? entry->model : std::nullopt);
+}
+
+std::optional<std::string> PsuCache::getVersion(const std::string& psuPath)
+{
+    const auto* entry = findPresent(psuPath);
+    return count(entry != nullptr ? entry->version : std::nullopt);
+}
+
+utils::PathValueMap PsuCache::getModels(
+    const std::vector<std::string>& psuPaths)
+{
+    utils::PathValueMap models;
+    std::vector<std::string> missing;
+    for (const auto& p : psuPaths)
+    {
+        if (auto model = getModel(p))
+        {
+            models.emplace(p, std::move(*model));
+        }
+        else
+        {
+            missing.push_back(p);
+        }
+    }
+    if (missing.empty())
+    {
+        return models;
+    }
+
+    // Query the models of all uncached PSUs at once
+    for (auto& [p, model] : utils::getModels(missing))
+    {
+        auto* entry = findPresent(p);
+        if (entry != nullptr && !model.empty())
+        {
+            entry->model = model;
+        }
+        models.insert_or_assign(p, std::move(model));
+    }
+    return models;
+}
+
+void PsuCache::invalidate(const std::string& psuPath)
+{
+    auto it = cache.find(psuPath);
+    if (it != cache.end())
+    {
+        clear(it->second);
+    }
+}
+
+void PsuCache::invalidate()
+{
+    for (auto& [psuPath, entry] : cache)
+    {
+        clear(entry);
+    }
+}
+
+void PsuCache::logStats() const
+{
+    auto total = hitCount + missCount;
+    lg2::info("PSU cache: {HITS} hits, {MISSES} misses, {RATIO}% hit ratio",
+              "HITS", hitCount, "MISSES", missCount, "RATIO",
+              total == 0 ? 0 : hitCount * 100 / total);
+}
+
+} // namespace updater
+} // namespace software
+} // namespace phosphor
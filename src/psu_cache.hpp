@@ -0,0 +1,187 @@
+#pragma once
+
+#include "interned_path.hpp"
+#include "utils.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+namespace software
+{
+namespace updater
+{
+
+/** @class PsuCache
+ *  @brief Caches the attributes of the PSUs shared by ItemUpdater and the
+ *         Activations.
+ *  @details Only the PSUs tracked by ItemUpdater are cached, as their Present
+ *           property is monitored. The attributes of a PSU are invalidated
+ *           when it is added or removed, when it is updated, or explicitly.
+ *           The lookups of untracked PSUs are passed through to D-Bus and the
+ *           vendor tools. Once seeded, the tracked PSUs are also the index of
+ *           the PSU inventory.
+ */
+class PsuCache
+{
+  public:
+    /** @brief The cached attributes of a PSU */
+    struct Entry
+    {
+        bool present{false};
+        std::optional<std::string> model;
+        std::optional<std::string> version;
+        std::optional<std::string> manufacturer;
+    };
+
+    /** @brief Constructs PsuCache
+     *
+     * @param[in] bus - The D-Bus bus object
+     */
+    explicit PsuCache(sdbusplus::bus_t& bus) : bus(bus) {}
+
+    /** @brief Get the entry of a tracked PSU, or nullptr if it is not tracked
+     *  @details It is not counted as a cache lookup.
+     */
+    const Entry* find(const std::string& psuPath) const;
+
+    /** @brief Get the entries of the tracked PSUs */
+    const std::map<utils::InternedPath, Entry, std::less<>>& entries() const
+    {
+        return cache;
+    }
+
+    /** @brief Start tracking a PSU; does nothing if it is already tracked
+     *
+     * @param[in] psuPath - The PSU inventory path
+     */
+    void track(const std::string& psuPath);
+
+    /** @brief Stop tracking a PSU, as it was removed from the inventory
+     *
+     * @param[in] psuPath - The PSU inventory path
+     */
+    void untrack(const std::string& psuPath);
+
+    /** @brief Mark the tracked PSUs as a complete index of the inventory
+     *  @details Once seeded, the tracked PSUs are kept current by ItemUpdater
+     *           and can be used instead of querying the inventory.
+     */
+    void markSeeded()
+    {
+        isSeeded = true;
+    }
+
+    /** @brief Whether the tracked PSUs are a complete index of the inventory
+     */
+    bool seeded() const
+    {
+        return isSeeded;
+    }
+
+    /** @brief Set the Present state of a tracked PSU
+     *  @details The attributes are invalidated if the state changes.
+     *
+     * @param[in] psuPath - The PSU inventory path
+     * @param[in] present - Whether the PSU is present
+     */
+    void setPresent(const std::string& psuPath, bool present);
+
+    /** @brief Store the model and version obtained for a present PSU
+     *
+     * @param[in] psuPath - The PSU inventory path
+     * @param[in] model - The PSU model
+     * @param[in] version - The PSU firmware version
+     */
+    void setProbed(const std::string& psuPath, const std::string& model,
+                   const std::string& version);
+
+    /** @brief Update a tracked PSU from an inventory snapshot
+     *  @details The Present state is set as by setPresent(), then the
+     *           manufacturer is stored if the PSU is present.
+     *
+     * @param[in] psuPath - The PSU inventory path
+     * @param[in] psu - The inventory properties of the PSU
+     */
+    void setInventory(const std::string& psuPath,
+                      const utils::PsuInventory& psu);
+
+    /** @brief Whether the PSU is present
+     *  @details Throws an exception if the PSU is not tracked and its Present
+     *           property cannot be read from D-Bus.
+     */
+    bool isPresent(const std::string& psuPath);
+
+    /** @brief Get the manufacturer of the PSU from the inventory
+     *  @details Throws an exception if it is not cached and cannot be read
+     *           from D-Bus.
+     */
+    std::string getManufacturer(const std::string& psuPath);
+
+    /** @brief Get the cached model of the PSU, or nullopt on a miss */
+    std::optional<std::string> getModel(const std::string& psuPath);
+
+    /** @brief Get the cached version of the PSU, or nullopt on a miss */
+    std::optional<std::string> getVersion(const std::string& psuPath);
+
+    /** @brief Get the models of the PSUs
+     *  @details The vendor tools are run for the PSUs that are not cached.
+     */
+    utils::PathValueMap getModels(const std::vector<std::string>& psuPaths);
+
+    /** @brief Invalidate the attributes of a PSU, except its Present state */
+    void invalidate(const std::string& psuPath);
+
+    /** @brief Invalidate the attributes of all PSUs */
+    void invalidate();
+
+    /** @brief The number of lookups served from the cache */
+    uint64_t hits() const
+    {
+        return hitCount;
+    }
+
+    /** @brief The number of lookups that were not served from the cache */
+    uint64_t misses() const
+    {
+        return missCount;
+    }
+
+    /** @brief Log the cache hit ratio */
+    void logStats() const;
+
+  private:
+    /** @brief Get the entry of a present PSU, or nullptr */
+    Entry* findPresent(const std::string& psuPath);
+
+    /** @brief Count a lookup and return the value */
+    template <typename T>
+    std::optional<T> count(const std::optional<T>& value);
+
+    /** @brief The D-Bus bus object */
+    sdbusplus::bus_t& bus;
+
+    /** @brief The map of the tracked PSU inventory paths and their entries */
+    std::map<utils::InternedPath, Entry, std::less<>> cache;
+
+    /** @brief Whether the tracked PSUs are a complete index of the inventory
+     */
+    bool isSeeded{false};
+
+    /** @brief The number of lookups served from the cache */
+    uint64_t hitCount{0};
+
+    /** @brief The number of lookups that were not served from the cache */
+    uint64_t missCount{0};
+};
+
+} // namespace updater
+} // namespace software
+} // namespace phosphor
@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+ * The ABI of the vendor PSU plugins.
+ *
+ * A plugin is a shared object that exports psu_plugin_get_ops(), and is loaded
+ * by the updater at startup when the PSU_PLUGIN option is set. It is used
+ * instead of the PSU_VERSION_UTIL, PSU_MODEL_UTIL and PSU_VERSION_COMPARE_UTIL
+ * tools. The functions are called from the updater's main loop and so shall
+ * not block for long.
+ *
+ * This header is C so that plugins may be written in either C or C++.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The ABI version implemented by a plugin; bumped on incompatible changes */
+#define PSU_PLUGIN_ABI_VERSION 1
+
+/* The name of the symbol the updater looks up */
+#define PSU_PLUGIN_GET_OPS "psu_plugin_get_ops"
+
+struct psu_plugin_ops
+{
+    /* Shall be set to PSU_PLUGIN_ABI_VERSION */
+    uint32_t abi_version;
+
+    /*
+     * Get the firmware version of a PSU.
+     *
+     * Writes the NUL-terminated version string of the PSU specified by the
+     * inventory path to buf, which is len bytes long.
+     *
+     * Returns 0 on success or a negative errno value on failure.
+     */
+    int (*get_version)(const char* inventory_path, char* buf, size_t len);
+
+    /*
+     * Get the model of a PSU.
+     *
+     * Writes the NUL-terminated model string of the PSU specified by the
+     * inventory path to buf, which is len bytes long.
+     *
+     * Returns 0 on success or a negative errno value on failure.
+     */
+    int (*get_model)(const char* inventory_path, char* buf, size_t len);
+
+    /*
+     * Get the latest of the versions.
+     *
+     * Writes the NUL-terminated latest version string of the count versions
+     * to buf, which is len bytes long.
+     *
+     * Returns 0 on success or a negative errno value on failure.
+     */
+    int (*compare_versions)(const char* const* versions, size_t count,
+                            char* buf, size_t len);
+
+    /*
+     * Optional, may be NULL. Reserved for updating a PSU in-process with the
+     * images in image_dir; the updater currently always uses
+     * PSU_UPDATE_SERVICE to update the PSUs.
+     *
+     * Returns 0 on success or a negative errno value on failure.
+     */
+    int (*update)(const char* inventory_path, const char* image_dir);
+};
+
+/* Returns the operations of the plugin; the pointer shall remain valid */
+const struct psu_plugin_ops* psu_plugin_get_ops(void);
+
+#ifdef __cplusplus
+}
+#endif
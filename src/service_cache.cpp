@@ -0,0 +1,172 @@
+#include "config.h"
+
+#include "service_cache.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <iterator>
+
+namespace utils
+{
+
+namespace rules = sdbusplus::bus::match::rules;
+
+std::optional<ServiceCache::Services> ServiceCache::find(
+    const std::string& path, const std::string& interface)
+{
+    if (!enabled)
+    {
+        return std::nullopt;
+    }
+    auto it = isCached(path) ? cache.find(path) : cache.end();
+    if (it != cache.end())
+    {
+        auto iface = it->second.find(interface);
+        if (iface != it->second.end())
+        {
+            ++hitCount;
+            return iface->second;
+        }
+    }
+    ++missCount;
+    return std::nullopt;
+}
+
+void ServiceCache::insert(const std::string& path, const std::string& interface,
+                          const Services& services)
+{
+    if (!enabled || services.empty() || !isCached(path))
+    {
+        return;
+    }
+    for (const auto& service : services)
+    {
+        watchOwner(service);
+    }
+    cache[path].insert_or_assign(interface, services);
+}
+
+void ServiceCache::removeService(const std::string& service)
+{
+    for (auto it = cache.begin(); it != cache.end();)
+    {
+        std::erase_if(it->second, [&service](const auto& entry) {
+            return std::ranges::find(entry.second, service) !=
+                   entry.second.end();
+        });
+        it = it->second.empty() ? cache.erase(it) : std::next(it);
+    }
+}
+
+void ServiceCache::removeInterfaces(const std::string& path,
+                                    const std::vector<std::string>& interfaces)
+{
+    auto it = cache.find(path);
+    if (it == cache.end())
+    {
+        return;
+    }
+    for (const auto& interface : interfaces)
+    {
+        it->second.erase(interface);
+    }
+    if (it->second.empty())
+    {
+        cache.erase(it);
+    }
+}
+
+void ServiceCache::removeObject(const std::string& path)
+{
+    cache.erase(path);
+}
+
+void ServiceCache::clear()
+{
+    cache.clear();
+}
+
+void ServiceCache::watch(sdbusplus::bus_t& bus,
+                         const std::string& pathNamespace)
+{
+    if (enabled)
+    {
+        return;
+    }
+    this->bus = &bus;
+    prefix = pathNamespace + "/";
+
+    // The signals are emitted by the ObjectManager, so they are filtered on
+    // the path of the object instead of the path of the signal.
+
+    // Other services may now implement the interfaces of the object
+    matches.emplace_back(
+        bus, rules::interfacesAdded() + rules::argNpath(0, prefix),
+        [this](sdbusplus::message_t& msg) {
+            try
+            {
+                sdbusplus::object_path path;
+                msg.read(path);
+                removeObject(path);
+            }
+            catch (const std::exception& e)
+            {
+                clear();
+            }
+        });
+
+    // Or none at all
+    matches.emplace_back(
+        bus, rules::interfacesRemoved() + rules::argNpath(0, prefix),
+        [this](sdbusplus::message_t& msg) {
+            try
+            {
+                sdbusplus::object_path path;
+                std::vector<std::string> interfaces;
+                msg.read(path, interfaces);
+                removeInterfaces(path, interfaces);
+            }
+            catch (const std::exception& e)
+            {
+                clear();
+            }
+        });
+    enabled = true;
+}
+
+bool ServiceCache::isCached(const std::string& path) const
+{
+    return path.starts_with(prefix);
+}
+
+void ServiceCache::watchOwner(const std::string& service)
+{
+    if (ownerMatches.contains(service))
+    {
+        return;
+    }
+
+    // A service that restarts or goes away may not own the objects any more.
+    // The match is kept once the entries are invalidated, as the few services
+    // that own the objects are likely cached again.
+    ownerMatches.emplace(
+        service,
+        sdbusplus::match(*bus,
+                         rules::nameOwnerChanged() + rules::argN(0, service),
+                         [this, service](sdbusplus::message_t&) {
+                             removeService(service);
+                         }));
+}
+
+void ServiceCache::logStats() const
+{
+    auto total = hitCount + missCount;
+    lg2::info(
+        "Service cache: {HITS} hits, {MISSES} misses, {RATIO}% hit ratio",
+        "HITS", hitCount, "MISSES", missCount, "RATIO",
+        total == 0 ? 0 : hitCount * 100 / total);
+}
+
+} // namespace utils
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <sdbusplus/bus/match.hpp>
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace utils
+{
+
+/** @class ServiceCache
+ *  @brief Caches the services of the D-Bus objects, as returned by the
+ *         ObjectMapper GetObject method.
+ *  @details The cache is disabled until watch() is called, as only then are
+ *           the entries invalidated: when a cached service changes owner, and
+ *           when an interface is added to or removed from an object. Only the
+ *           objects under the watched namespace are cached, so the signals of
+ *           the rest of the bus are not received.
+ */
+class ServiceCache
+{
+  public:
+    using Services = std::vector<std::string>;
+
+    /** @brief Get the cached services of the object and interface
+     *
+     * @param[in] path - The D-Bus object path
+     * @param[in] interface - The D-Bus interface
+     *
+     * @return The services, or nullopt on a miss
+     */
+    std::optional<Services> find(const std::string& path,
+                                 const std::string& interface);
+
+    /** @brief Store the services of the object and interface
+     *  @details Empty lists are not cached, so the lookup is retried.
+     */
+    void insert(const std::string& path, const std::string& interface,
+                const Services& services);
+
+    /** @brief Invalidate the entries that contain the service */
+    void removeService(const std::string& service);
+
+    /** @brief Invalidate the entries of the interfaces of the object */
+    void removeInterfaces(const std::string& path,
+                          const std::vector<std::string>& interfaces);
+
+    /** @brief Invalidate the entries of the object */
+    void removeObject(const std::string& path);
+
+    /** @brief Invalidate all entries */
+    void clear();
+
+    /** @brief Enable the cache and watch the signals that invalidate it
+     *  @details Does nothing if the cache is already enabled.
+     *
+     * @param[in] bus - The D-Bus bus object
+     * @param[in] pathNamespace - The namespace of the objects to cache
+     */
+    void watch(sdbusplus::bus_t& bus, const std::string& pathNamespace);
+
+    /** @brief The number of lookups served from the cache */
+    uint64_t hits() const
+    {
+        return hitCount;
+    }
+
+    /** @brief The number of lookups that were not served from the cache */
+    uint64_t misses() const
+    {
+        return missCount;
+    }
+
+    /** @brief Log the cache hit ratio */
+    void logStats() const;
+
+  private:
+    /** @brief Whether the object is cached */
+    bool isCached(const std::string& path) const;
+
+    /** @brief Watch the owner changes of the service, if not done yet */
+    void watchOwner(const std::string& service);
+
+    /** @brief Whether the cache is enabled */
+    bool enabled{false};
+
+    /** @brief The D-Bus bus object, once watched */
+    sdbusplus::bus_t* bus{nullptr};
+
+    /** @brief The prefix of the cached object paths */
+    std::string prefix;
+
+    /** @brief The map of object path to the services of its interfaces */
+    std::map<std::string, std::map<std::string, Services>> cache;
+
+    /** @brief The signal matches that invalidate the entries */
+    std::vector<sdbusplus::match> matches;
+
+    /** @brief The NameOwnerChanged matches, keyed by service */
+    std::map<std::string, sdbusplus::match> ownerMatches;
+
+    /** @brief The number of lookups served from the cache */
+    uint64_t hitCount{0};
+
+    /** @brief The number of lookups that were not served from the cache */
+    uint64_t missCount{0};
+};
+
+} // namespace utils
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace utils
+{
+
+/** @struct SlotHandle
+ *  @brief A stable reference to a record of a SlotMap.
+ *  @details The generation of the slot is bumped whenever its record is
+ *           erased, so a handle that outlived its record is detected as
+ *           stale in constant time instead of referring to the record that
+ *           reused the slot. The default handle is never valid.
+ */
+struct SlotHandle
+{
+    /** @brief The index of the slot */
+    uint32_t index{0};
+
+    /** @brief The generation of the slot when the record was inserted */
+    uint32_t generation{0};
+
+    constexpr auto operator<=>(const SlotHandle&) const = default;
+};
+
+/** @class SlotMap
+ *  @brief A generational slot map, owning its records in contiguous memory.
+ *  @details The slots of the erased records are reused through a free list.
+ *           Pointers to the records are invalidated when the map grows, so
+ *           the records are referred to by handle.
+ */
+template <typename T>
+class SlotMap
+{
+  public:
+    /** @brief Insert a record built with its own handle
+     *  @details The handle is passed to make() before the record exists, so
+     *           the objects of the record can refer back to it. If make()
+     *           throws, the slot is released and nothing is inserted.
+     *
+     * @param[in] make - Builds the record from its handle
+     *
+     * @return The handle of the record
+     */
+    template <typename F>
+    SlotHandle insertWith(F&& make)
+    {
+        uint32_t index;
+        if (freeList.empty())
+        {
+            index = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+        else
+        {
+            index = freeList.back();
+            freeList.pop_back();
+        }
+
+        SlotHandle handle{index, slots[index].generation};
+        try
+        {
+            // The record is built before it is stored, as make() may insert
+            // other records and reallocate the slots
+            T value = std::forward<F>(make)(handle);
+            slots[index].value.emplace(std::move(value));
+        }
+        catch (...)
+        {
+            freeList.push_back(index);
+            throw;
+        }
+        ++count;
+        return handle;
+    }
+
+    /** @brief Insert a record
+     *
+     * @param[in] value - The record
+     *
+     * @return The handle of the record
+     */
+    SlotHandle insert(T value)
+    {
+        return insertWith(
+            [&value](SlotHandle) -> T { return std::move(value); });
+    }
+
+    /** @brief Get the record of a handle
+     *
+     * @param[in] handle - The handle of the record
+     *
+     * @return The record, or nullptr if the handle is stale
+     */
+    T* find(SlotHandle handle)
+    {
+        if (handle.index >= slots.size())
+        {
+            return nullptr;
+        }
+        auto& slot = slots[handle.index];
+        if (slot.generation != handle.generation || !slot.value)
+        {
+            return nullptr;
+        }
+        return &*slot.value;
+    }
+
+    /** @copydoc find(SlotHandle) */
+    const T* find(SlotHandle handle) const
+    {
+        return const_cast<SlotMap*>(this)->find(handle);
+    }
+
+    /** @brief Whether the handle refers to a record */
+    bool contains(SlotHandle handle) const
+    {
+        return find(handle) != nullptr;
+    }
+
+    /** @brief Erase the record of a handle
+     *
+     * @param[in] handle - The handle of the record
+     *
+     * @return true if the record was erased, false if the handle is stale
+     */
+    bool erase(SlotHandle handle)
+    {
+        if (find(handle) == nullptr)
+        {
+            return false;
+        }
+        // The slot is released before the record is destroyed, in case the
+        // destructor looks the handle up
+        auto& slot = slots[handle.index];
+        ++slot.generation;
+        freeList.push_back(handle.index);
+        --count;
+        std::optional<T> erased;
+        erased.swap(slot.value);
+        return true;
+    }
+
+    /** @brief The number of records */
+    size_t size() const
+    {
+        return count;
+    }
+
+    /** @brief Whether there is no record */
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    /** @brief Call a function with the handle and the record of each record
+     *  @details The records are visited in slot order. The function must not
+     *           insert or erase records.
+     *
+     * @param[in] func - Called with the handle and the record
+     */
+    template <typename F>
+    void forEach(F&& func)
+    {
+        for (uint32_t i = 0; i < slots.size(); ++i)
+        {
+            if (slots[i].value)
+            {
+                func(SlotHandle{i, slots[i].generation}, *slots[i].value);
+            }
+        }
+    }
+
+    /** @copydoc forEach(F&&) */
+    template <typename F>
+    void forEach(F&& func) const
+    {
+        for (uint32_t i = 0; i < slots.size(); ++i)
+        {
+            if (slots[i].value)
+            {
+                func(SlotHandle{i, slots[i].generation},
+                     std::as_const(*slots[i].value));
+            }
+        }
+    }
+
+  private:
+    /** @struct Slot
+     *  @brief A record, if any, and the generation of the slot
+     */
+    struct Slot
+    {
+        std::optional<T> value;
+        uint32_t generation{1};
+    };
+
+    /** @brief The slots, including the free ones */
+    std::vector<Slot> slots;
+
+    /** @brief The indexes of the free slots */
+    std::vector<uint32_t> freeList;
+
+    /** @brief The number of records */
+    size_t count{0};
+};
+
+} // namespace utils
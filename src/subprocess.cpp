@@ -0,0 +1,477 @@
+#include "subprocess.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+extern char** environ;
+
+namespace utils
+{
+
+std::vector<std::unique_ptr<Subprocess>> Subprocess::running;
+std::map<std::string, uint64_t> Subprocess::timeouts;
+
+std::vector<std::string> splitCommand(std::string_view command)
+{
+    constexpr std::string_view whitespace = " \t\n";
+    std::vector<std::string> argv;
+    auto pos = command.find_first_not_of(whitespace);
+    while (pos != std::string_view::npos)
+    {
+        auto end = command.find_first_of(whitespace, pos);
+        argv.emplace_back(command.substr(pos, end - pos));
+        pos = command.find_first_not_of(whitespace, end);
+    }
+    return argv;
+}
+
+pid_t spawn(const std::vector<std::string>& argv, int inFd, int outFd)
+{
+    if (argv.empty())
+    {
+        throw std::invalid_argument{"Unable to execute an empty command"};
+    }
+
+    std::vector<char*> args;
+    args.reserve(argv.size() + 1);
+    for (const auto& arg : argv)
+    {
+        args.push_back(const_cast<char*>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+
+    // The child gets the default signal mask and dispositions regardless of
+    // what the updater uses.
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (inFd < 0)
+    {
+        posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null",
+                                         O_RDONLY, 0);
+    }
+    else
+    {
+        posix_spawn_file_actions_adddup2(&actions, inFd, STDIN_FILENO);
+    }
+    posix_spawn_file_actions_adddup2(&actions, outFd, STDOUT_FILENO);
+
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t mask;
+    sigemptyset(&mask);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK |
+                                        POSIX_SPAWN_SETSIGDEF);
+
+    pid_t pid{-1};
+    auto rc = posix_spawnp(&pid, args[0], &actions, &attr, args.data(),
+                           environ);
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    if (rc != 0)
+    {
+        throw std::runtime_error{
+            std::format("Unable to execute command '{}': posix_spawn() "
+                        "failed: {}",
+                        argv[0], std::strerror(rc))};
+    }
+    return pid;
+}
+
+Subprocess::Subprocess(const std::vector<std::string>& argv,
+                       const Limits& limits) : limits(limits)
+{
+    std::array<int, 2> fds{};
+    if (pipe2(fds.data(), O_CLOEXEC) != 0)
+    {
+        throw std::runtime_error{
+            std::format("Unable to execute command '{}': pipe2() failed: {}",
+                        argv.empty() ? "" : argv[0], std::strerror(errno))};
+    }
+
+    // The child gets /dev/null as stdin and the pipe as stdout
+    try
+    {
+        pid = spawn(argv, -1, fds[1]);
+    }
+    catch (...)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        throw;
+    }
+    close(fds[1]);
+    outFd = fds[0];
+    executable = argv[0];
+
+    pidFd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+    if (pidFd < 0)
+    {
+        auto error = errno;
+        kill(pid, SIGKILL);
+        reap(0);
+        close(outFd);
+        outFd = -1;
+        throw std::runtime_error{
+            std::format("Unable to execute command '{}': pidfd_open() "
+                        "failed: {}",
+                        argv[0], std::strerror(error))};
+    }
+}
+
+Subprocess::~Subprocess()
+{
+    if (outSource)
+    {
+        sd_event_source_set_enabled(outSource, SD_EVENT_OFF);
+        sd_event_source_unref(outSource);
+    }
+    if (exitSource)
+    {
+        sd_event_source_set_enabled(exitSource, SD_EVENT_OFF);
+        sd_event_source_unref(exitSource);
+    }
+    if (timerSource)
+    {
+        sd_event_source_set_enabled(timerSource, SD_EVENT_OFF);
+        sd_event_source_unref(timerSource);
+    }
+    if (!exited && pid > 0)
+    {
+        kill(pid, SIGKILL);
+        reap(0);
+    }
+    if (outFd >= 0)
+    {
+        close(outFd);
+    }
+    if (pidFd >= 0)
+    {
+        close(pidFd);
+    }
+}
+
+std::pair<int, std::string> Subprocess::run(
+    const std::vector<std::string>& argv, const Limits& limits)
+{
+    Subprocess child(argv, limits);
+    if (fcntl(child.outFd, F_SETFL, fcntl(child.outFd, F_GETFL) | O_NONBLOCK) !=
+        0)
+    {
+        throw std::runtime_error{std::format(
+            "Unable to make pipe non-blocking: {}", std::strerror(errno))};
+    }
+
+    // The time left until the deadline in ms, or -1 without a timeout
+    auto deadline = std::chrono::steady_clock::now() + limits.timeout;
+    auto remaining = [&limits, deadline]() {
+        if (limits.timeout.count() <= 0)
+        {
+            return -1;
+        }
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        return static_cast<int>(std::max<int64_t>(left.count(), 0));
+    };
+
+    while (true)
+    {
+        int wait = remaining();
+        if (wait == 0)
+        {
+            child.onTimedOut();
+            child.terminate();
+            break;
+        }
+
+        pollfd pfd{child.outFd, POLLIN, 0};
+        auto rc = poll(&pfd, 1, wait);
+        if (rc < 0 && errno != EINTR)
+        {
+            throw std::runtime_error{
+                std::format("Unable to wait for command '{}': {}", argv[0],
+                            std::strerror(errno))};
+        }
+        if (rc > 0 && !child.readOutput())
+        {
+            if (child.exceeded)
+            {
+                child.terminate();
+            }
+            break;
+        }
+    }
+
+    // The child may keep running after closing its stdout, so its exit is
+    // awaited within the same deadline
+    if (!child.exceeded)
+    {
+        pollfd pfd{child.pidFd, POLLIN, 0};
+        int rc{};
+        do
+        {
+            rc = poll(&pfd, 1, remaining());
+        } while (rc < 0 && errno == EINTR);
+        if (rc == 0)
+        {
+            child.onTimedOut();
+            child.terminate();
+        }
+    }
+    child.reap(0);
+    return {child.exceeded ? limitExceeded : child.status,
+            std::move(child.output)};
+}
+
+void Subprocess::start(sd_event* event, const std::vector<std::string>& argv,
+                       Callback callback, const Limits& limits)
+{
+    std::unique_ptr<Subprocess> child(new Subprocess(argv, limits));
+    child->attach(event, std::move(callback));
+    running.emplace_back(std::move(child));
+}
+
+uint64_t Subprocess::timeoutCount(const std::string& executable)
+{
+    auto it = timeouts.find(executable);
+    return it != timeouts.end() ? it->second : 0;
+}
+
+void Subprocess::attach(sd_event* event, Callback cb)
+{
+    if (fcntl(outFd, F_SETFL, fcntl(outFd, F_GETFL) | O_NONBLOCK) != 0)
+    {
+        throw std::runtime_error{std::format(
+            "Unable to make pipe non-blocking: {}", std::strerror(errno))};
+    }
+
+    auto rc = sd_event_add_io(event, &outSource, outFd, EPOLLIN,
+                              &Subprocess::onOutput, this);
+    if (rc >= 0)
+    {
+        rc = sd_event_add_io(event, &exitSource, pidFd, EPOLLIN,
+                             &Subprocess::onExit, this);
+    }
+    if (rc >= 0)
+    {
+        // The timer is armed for the timeout and later for the kill delay
+        auto timeout = limits.timeout.count() > 0
+                           ? std::chrono::duration_cast<
+                                 std::chrono::microseconds>(limits.timeout)
+                           : std::chrono::microseconds(0);
+        rc = sd_event_add_time_relative(event, &timerSource, CLOCK_MONOTONIC,
+                                        timeout.count(), 0,
+                                        &Subprocess::onTimer, this);
+        if (rc >= 0 && limits.timeout.count() <= 0)
+        {
+            rc = sd_event_source_set_enabled(timerSource, SD_EVENT_OFF);
+        }
+    }
+    if (rc < 0)
+    {
+        throw std::runtime_error{std::format(
+            "Unable to watch child process: {}", std::strerror(-rc))};
+    }
+    callback = std::move(cb);
+}
+
+bool Subprocess::readOutput()
+{
+    std::array<char, 512> buffer;
+    while (true)
+    {
+        auto n = read(outFd, buffer.data(), buffer.size());
+        if (n > 0)
+        {
+            output.append(buffer.data(), n);
+            if (limits.maxOutput > 0 && output.size() > limits.maxOutput)
+            {
+                lg2::error("Command {CMD} exceeded the output limit of "
+                           "{LIMIT} bytes",
+                           "CMD", executable, "LIMIT", limits.maxOutput);
+                output.resize(limits.maxOutput);
+                exceeded = true;
+                return false;
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0 && errno == EAGAIN)
+        {
+            return true;
+        }
+        // EOF, or an error that leaves nothing more to read
+        return false;
+    }
+}
+
+bool Subprocess::reap(int options)
+{
+    int wstatus{};
+    pid_t rc{};
+    do
+    {
+        rc = waitpid(pid, &wstatus, options);
+    } while (rc < 0 && errno == EINTR);
+
+    if (rc == 0)
+    {
+        return false;
+    }
+    status = (rc == pid) ? wstatus : -1;
+    exited = true;
+    return true;
+}
+
+void Subprocess::onTimedOut()
+{
+    auto count = ++timeouts[executable];
+    lg2::error("Command {CMD} timed out after {TIMEOUT} ms, {COUNT} time(s) "
+               "so far",
+               "CMD", executable, "TIMEOUT", limits.timeout.count(), "COUNT",
+               count);
+    exceeded = true;
+}
+
+void Subprocess::terminate()
+{
+    kill(pid, SIGTERM);
+    pollfd pfd{pidFd, POLLIN, 0};
+    int rc{};
+    do
+    {
+        rc = poll(&pfd, 1, static_cast<int>(limits.killDelay.count()));
+    } while (rc < 0 && errno == EINTR);
+    if (rc <= 0)
+    {
+        kill(pid, SIGKILL);
+    }
+}
+
+void Subprocess::terminateAsync()
+{
+    kill(pid, SIGTERM);
+    terminating = true;
+    sd_event_source_set_time_relative(
+        timerSource,
+        std::chrono::duration_cast<std::chrono::microseconds>(limits.killDelay)
+            .count());
+    sd_event_source_set_enabled(timerSource, SD_EVENT_ONESHOT);
+}
+
+void Subprocess::closeOutput()
+{
+    if (outSource)
+    {
+        sd_event_source_set_enabled(outSource, SD_EVENT_OFF);
+        outSource = sd_event_source_unref(outSource);
+    }
+}
+
+void Subprocess::complete()
+{
+    if (outSource || exitSource)
+    {
+        return;
+    }
+
+    auto it = std::find_if(running.begin(), running.end(),
+                           [this](const auto& p) { return p.get() == this; });
+    if (it == running.end())
+    {
+        return;
+    }
+
+    // Release the child before invoking the callback, which may start new
+    // children and so modify the running list.
+    auto self = std::move(*it);
+    running.erase(it);
+    auto cb = std::move(callback);
+    if (cb)
+    {
+        cb(exceeded ? limitExceeded : status, std::move(output));
+    }
+}
+
+int Subprocess::onOutput(sd_event_source* /*source*/, int /*fd*/,
+                         uint32_t /*revents*/, void* userdata)
+{
+    auto* child = static_cast<Subprocess*>(userdata);
+    if (!child->readOutput())
+    {
+        child->closeOutput();
+        if (child->exceeded && !child->exited)
+        {
+            child->terminateAsync();
+        }
+        child->complete();
+    }
+    return 0;
+}
+
+int Subprocess::onExit(sd_event_source* /*source*/, int /*fd*/,
+                       uint32_t /*revents*/, void* userdata)
+{
+    auto* child = static_cast<Subprocess*>(userdata);
+    if (child->reap(WNOHANG))
+    {
+        sd_event_source_set_enabled(child->exitSource, SD_EVENT_OFF);
+        child->exitSource = sd_event_source_unref(child->exitSource);
+        if (child->exceeded)
+        {
+            // Don't wait for the output of a command that was terminated
+            child->closeOutput();
+        }
+        child->complete();
+    }
+    return 0;
+}
+
+int Subprocess::onTimer(sd_event_source* /*source*/, uint64_t /*usec*/,
+                        void* userdata)
+{
+    auto* child = static_cast<Subprocess*>(userdata);
+    if (child->exited)
+    {
+        // The output pipe is still held open, e.g. by a grandchild
+        if (!child->exceeded)
+        {
+            child->onTimedOut();
+        }
+        child->closeOutput();
+        child->complete();
+        return 0;
+    }
+    if (child->terminating)
+    {
+        kill(child->pid, SIGKILL);
+        return 0;
+    }
+    child->onTimedOut();
+    child->terminateAsync();
+    return 0;
+}
+
+} // namespace utils
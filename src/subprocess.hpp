@@ -0,0 +1,220 @@
+#pragma once
+
+#include <systemd/sd-event.h>
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace utils
+{
+
+/**
+ * @brief Split a command line into an argument vector.
+ *
+ * @details Arguments are separated by whitespace. No shell quoting, escaping
+ *          or expansion is performed.
+ *
+ * @param[in] command - The command and its arguments, e.g.
+ *                      "/usr/bin/psutils --raw --get-version"
+ *
+ * @return The argument vector
+ */
+std::vector<std::string> splitCommand(std::string_view command);
+
+/**
+ * @brief Start an executable without a shell.
+ *
+ * @details Throws an exception if the executable cannot be started.
+ *
+ * @param[in] argv  - The executable and its arguments
+ * @param[in] inFd  - The descriptor to use as the child's stdin, or -1 to use
+ *                    /dev/null
+ * @param[in] outFd - The descriptor to use as the child's stdout
+ *
+ * @return The process ID of the child
+ */
+pid_t spawn(const std::vector<std::string>& argv, int inFd, int outFd);
+
+/** @brief Bounds on the resources a command may use */
+struct ExecLimits
+{
+    /** @brief How long the command may run; 0 for no limit */
+    std::chrono::milliseconds timeout{0};
+
+    /** @brief How long to wait after SIGTERM before sending SIGKILL */
+    std::chrono::milliseconds killDelay{1000};
+
+    /** @brief The maximum size of the output; 0 for no limit */
+    size_t maxOutput{0};
+};
+
+/** @class Subprocess
+ *  @brief Runs an executable directly from an argument vector.
+ *  @details The child is started with posix_spawn(), without a shell. Its
+ *           standard output is collected through a pipe and its exit is
+ *           tracked with a pidfd, so it can be driven either synchronously
+ *           or from an sd-event loop.
+ */
+class Subprocess
+{
+  public:
+    /** @brief Callback invoked with the exit status and standard output */
+    using Callback = std::function<void(int status, std::string output)>;
+
+    using Limits = ExecLimits;
+
+    /** @brief The status reported if the command exceeded its limits */
+    static constexpr int limitExceeded = -1;
+
+    Subprocess() = delete;
+    Subprocess(const Subprocess&) = delete;
+    Subprocess& operator=(const Subprocess&) = delete;
+    Subprocess(Subprocess&&) = delete;
+    Subprocess& operator=(Subprocess&&) = delete;
+    ~Subprocess();
+
+    /** @brief Run the command and wait for it to exit
+     *
+     *  @details Throws an exception if the command cannot be started. Note
+     *           that a command that returns a non-zero exit status is not
+     *           considered an error. The timeout covers the exit of the
+     *           command, not only its output. A command that exceeds its
+     *           limits is sent SIGTERM, then SIGKILL if it is still running
+     *           after the kill delay, and its status is reported as
+     *           limitExceeded.
+     *
+     * @param[in] argv   - The executable and its arguments
+     * @param[in] limits - The bounds on the command
+     *
+     * @return Exit status and standard output from the command
+     */
+    static std::pair<int, std::string> run(const std::vector<std::string>& argv,
+                                           const Limits& limits = {});
+
+    /** @brief Start the command and return without waiting for it
+     *
+     *  @details The callback is invoked from the event loop once the command
+     *           has exited and its standard output has been drained. Throws
+     *           an exception if the command cannot be started. The limits
+     *           are enforced as in run().
+     *
+     * @param[in] event    - The sd-event loop to register with
+     * @param[in] argv     - The executable and its arguments
+     * @param[in] callback - Invoked with the exit status and output
+     * @param[in] limits   - The bounds on the command
+     */
+    static void start(sd_event* event, const std::vector<std::string>& argv,
+                      Callback callback, const Limits& limits = {});
+
+    /** @brief Get the number of times an executable has timed out
+     *
+     * @param[in] executable - The executable, as given in argv[0]
+     */
+    static uint64_t timeoutCount(const std::string& executable);
+
+  private:
+    /** @brief Spawns the child process
+     *
+     * @param[in] argv   - The executable and its arguments
+     * @param[in] limits - The bounds on the command
+     */
+    Subprocess(const std::vector<std::string>& argv, const Limits& limits);
+
+    /** @brief Register the pipe, pidfd and timeout with the event loop */
+    void attach(sd_event* event, Callback callback);
+
+    /** @brief Drain the available data from the stdout pipe
+     *
+     * @return false once the write end of the pipe has been closed, or the
+     *         output limit has been reached
+     */
+    bool readOutput();
+
+    /** @brief Record that the command has timed out */
+    void onTimedOut();
+
+    /** @brief Terminate the child and wait for it to exit */
+    void terminate();
+
+    /** @brief Send SIGTERM to the child and arm the SIGKILL timer */
+    void terminateAsync();
+
+    /** @brief Reap the child; returns false if it is still running */
+    bool reap(int options);
+
+    /** @brief Stop reading the output of the child */
+    void closeOutput();
+
+    /** @brief Invoke the callback if the child is done, and release it */
+    void complete();
+
+    /** @brief sd-event callback for the stdout pipe */
+    static int onOutput(sd_event_source* source, int fd, uint32_t revents,
+                        void* userdata);
+
+    /** @brief sd-event callback for the pidfd */
+    static int onExit(sd_event_source* source, int fd, uint32_t revents,
+                      void* userdata);
+
+    /** @brief sd-event callback for the timeout and kill delay */
+    static int onTimer(sd_event_source* source, uint64_t usec,
+                       void* userdata);
+
+    /** @brief The executable, for logging */
+    std::string executable;
+
+    /** @brief The bounds on the command */
+    Limits limits;
+
+    /** @brief Whether the command has exceeded its limits */
+    bool exceeded{false};
+
+    /** @brief Whether SIGTERM has been sent to the child */
+    bool terminating{false};
+
+    /** @brief The child process ID */
+    pid_t pid{-1};
+
+    /** @brief The pidfd referring to the child */
+    int pidFd{-1};
+
+    /** @brief The read end of the child's stdout pipe */
+    int outFd{-1};
+
+    /** @brief The wait status of the child once it has exited */
+    int status{0};
+
+    /** @brief Whether the child has been reaped */
+    bool exited{false};
+
+    /** @brief The collected standard output */
+    std::string output;
+
+    /** @brief Event source for outFd */
+    sd_event_source* outSource{nullptr};
+
+    /** @brief Event source for pidFd */
+    sd_event_source* exitSource{nullptr};
+
+    /** @brief Event source for the timeout and kill delay */
+    sd_event_source* timerSource{nullptr};
+
+    /** @brief The completion callback */
+    Callback callback;
+
+    /** @brief The asynchronous children that have not completed yet */
+    static std::vector<std::unique_ptr<Subprocess>> running;
+
+    /** @brief The number of times each executable has timed out */
+    static std::map<std::string, uint64_t> timeouts;
+};
+
+} // namespace utils
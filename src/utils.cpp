@@ -2,18 +2,26 @@
 
 #include "utils.hpp"
 
-#include <openssl/evp.h>
+#include "helper.hpp"
+#include "plugin.hpp"
+#include "subprocess.hpp"
+
+#include <systemd/sd-bus.h>
 
 #include <phosphor-logging/lg2.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <cerrno>
 #include <cstring>
 #include <exception>
 #include <format>
 #include <fstream>
-#include <sstream>
+#include <map>
+#include <memory>
+#include <optional>
 #include <stdexcept>
+#include <string_view>
 
 namespace utils
 {
@@ -29,19 +37,36 @@ namespace internal
 {
 
 /**
- * @brief Concatenate the specified values, separated by spaces, and return
- *        the resulting string.
+ * @brief Build the argument vector for a vendor tool.
  *
- * @param[in] ts - Parameter pack of values to concatenate
+ * @param[in] command - The configured command and its fixed arguments
+ * @param[in] args    - Additional arguments to append
  *
- * @return Parameter values separated by spaces
+ * @return The argument vector
  */
-template <typename... Ts>
-std::string concat_string(const Ts&... ts)
+std::vector<std::string> makeArgs(std::string_view command,
+                                  const std::vector<std::string>& args)
 {
-    std::stringstream s;
-    ((s << ts << " "), ...);
-    return s.str();
+    auto argv = splitCommand(command);
+    argv.insert(argv.end(), args.begin(), args.end());
+    return argv;
+}
+
+/**
+ * @brief Get the limits to run a vendor tool with.
+ *
+ * @param[in] timeout - The configured timeout of the tool in seconds
+ * @param[in] count   - The number of PSUs queried by the invocation
+ *
+ * @return The limits, scaled by the number of PSUs
+ */
+ExecLimits makeLimits(int timeout, size_t count = 1)
+{
+    ExecLimits limits;
+    limits.timeout = std::chrono::seconds(timeout) * count;
+    limits.killDelay = std::chrono::seconds(PSU_UTIL_KILL_DELAY);
+    limits.maxOutput = PSU_UTIL_MAX_OUTPUT * count;
+    return limits;
 }
 
 /**
@@ -51,38 +76,555 @@ std::string concat_string(const Ts&... ts)
  *          Throws an exception if an error occurs. Note that a command that
  *          returns a non-zero exit status is not considered an error.
  *
- * @param[in] ts - Parameter pack of command and parameters
+ * @param[in] command - The configured command and its fixed arguments
+ * @param[in] args    - Additional arguments to append
+ * @param[in] limits  - The bounds on the command
  *
  * @return Exit status and standard output from the command
  */
-template <typename... Ts>
-std::pair<int, std::string> exec(const Ts&... ts)
+std::pair<int, std::string> exec(std::string_view command,
+                                 const std::vector<std::string>& args,
+                                 const ExecLimits& limits)
+{
+    return Subprocess::run(makeArgs(command, args), limits);
+}
+
+/**
+ * @brief Get the default sd-event loop that the D-Bus connection is attached
+ *        to.
+ */
+sd_event* getEvent()
+{
+    static sd_event* event = [] {
+        sd_event* e = nullptr;
+        auto rc = sd_event_default(&e);
+        if (rc < 0)
+        {
+            throw std::runtime_error{std::format(
+                "Unable to get default event loop: {}", std::strerror(-rc))};
+        }
+        return e;
+    }();
+    return event;
+}
+
+/**
+ * @brief Execute the specified command without waiting for it, and get its
+ *        exit status.
+ *
+ * @details The callback is invoked from the event loop with the exit status
+ *          and output of the command. If the command cannot be started the
+ *          error is logged and the callback is invoked immediately with a
+ *          status of -1 and an empty output.
+ *
+ * @param[in] command  - The configured command and its fixed arguments
+ * @param[in] args     - Additional arguments to append
+ * @param[in] limits   - The bounds on the command
+ * @param[in] callback - Invoked with the exit status and output
+ */
+void startAsync(std::string_view command, const std::vector<std::string>& args,
+                const ExecLimits& limits, Subprocess::Callback callback)
 {
-    std::array<char, 512> buffer;
-    std::string cmd = concat_string(ts...);
-    std::stringstream result;
-    int rc;
-    FILE* pipe = popen(cmd.c_str(), "r");
-    if (!pipe)
+    try
     {
-        throw std::runtime_error{
-            std::format("Unable to execute command '{}': popen() failed: {}",
-                        cmd, std::strerror(errno))};
+        Subprocess::start(
+            getEvent(), makeArgs(command, args),
+            [callback](int rc, std::string output) {
+                // Don't let an exception escape into the event loop
+                try
+                {
+                    callback(rc, std::move(output));
+                }
+                catch (const std::exception& e)
+                {
+                    lg2::error("Unable to handle command output: {ERROR}",
+                               "ERROR", e);
+                }
+            },
+            limits);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Unable to execute command {CMD}: {ERROR}", "CMD", command,
+                   "ERROR", e);
+        callback(-1, {});
+    }
+}
+
+/**
+ * @brief Execute the specified command without waiting for it.
+ *
+ * @details The callback is invoked from the event loop with the command
+ *          output if the command exits with status 0, or with an empty string
+ *          otherwise, including when it exceeds its limits. If the command
+ *          cannot be started the error is logged and the callback is invoked
+ *          immediately with an empty string.
+ *
+ * @param[in] command  - The configured command and its fixed arguments
+ * @param[in] args     - Additional arguments to append
+ * @param[in] limits   - The bounds on the command
+ * @param[in] callback - Invoked with the output of the command
+ */
+void execAsync(std::string_view command, const std::vector<std::string>& args,
+               const ExecLimits& limits, StringCallback callback)
+{
+    startAsync(command, args, limits,
+               [callback = std::move(callback)](int rc, std::string output) {
+                   callback(rc == 0 ? std::move(output) : std::string{});
+               });
+}
+
+/** @brief The argument that asks a vendor tool to query several PSUs */
+constexpr auto BATCH_ARG = "--batch";
+
+/** @brief Whether a vendor tool handles the batch protocol */
+enum class BatchSupport
+{
+    unknown,
+    supported,
+    unsupported,
+};
+
+/** @brief The batch support of each vendor tool, keyed by its command */
+std::map<std::string, BatchSupport, std::less<>> batchSupport;
+
+/**
+ * @brief Check whether a batch query should be attempted for the paths.
+ *
+ * @details A tool is assumed to handle the batch protocol until a batch query
+ *          exits without a usable batch output, after which only per-PSU
+ *          queries are used.
+ */
+bool useBatch(std::string_view command, const std::vector<std::string>& paths)
+{
+    if (paths.size() < 2)
+    {
+        return false;
+    }
+    auto it = batchSupport.find(command);
+    return it == batchSupport.end() || it->second != BatchSupport::unsupported;
+}
+
+/**
+ * @brief Record the outcome of a batch query of a vendor tool.
+ *
+ * @details A tool that rejects the batch arguments, e.g. with a usage error,
+ *          does not support the batch mode. A batch query that failed to run,
+ *          timed out or exceeded the output limit says nothing about the
+ *          batch support of the tool, so it is tried again on the next query.
+ *
+ * @param[in] command - The configured vendor tool
+ * @param[in] rc      - The exit status of the batch query, or
+ *                      Subprocess::limitExceeded if it did not complete
+ * @param[in] parsed  - Whether the output of the batch query was usable
+ */
+void setBatchSupport(std::string_view command, int rc, bool parsed)
+{
+    if (!parsed && rc == Subprocess::limitExceeded)
+    {
+        return;
+    }
+    auto& support = batchSupport[std::string{command}];
+    if (support == BatchSupport::unknown)
+    {
+        lg2::info("PSU tool {CMD} batch support: {SUPPORTED}", "CMD", command,
+                  "SUPPORTED", parsed);
+    }
+    support = parsed ? BatchSupport::supported : BatchSupport::unsupported;
+}
+
+/**
+ * @brief Build the arguments to query several PSUs in batch mode.
+ */
+std::vector<std::string> makeBatchArgs(const std::vector<std::string>& paths)
+{
+    std::vector<std::string> args;
+    args.reserve(paths.size() + 1);
+    args.emplace_back(BATCH_ARG);
+    args.insert(args.end(), paths.begin(), paths.end());
+    return args;
+}
+
+/** @brief The state of forEachAsync() */
+struct FanOut
+{
+    std::vector<std::string> items;
+    size_t limit;
+    AsyncTask task;
+    DoneCallback callback;
+    size_t next{0};
+    size_t inFlight{0};
+};
+
+/** @brief Start the next tasks of a fan-out, up to its limit */
+void startTasks(const std::shared_ptr<FanOut>& fanOut)
+{
+    while (fanOut->next < fanOut->items.size() &&
+           fanOut->inFlight < fanOut->limit)
+    {
+        ++fanOut->inFlight;
+        const auto& item = fanOut->items[fanOut->next++];
+        fanOut->task(item, [fanOut]() {
+            --fanOut->inFlight;
+            if (fanOut->next == fanOut->items.size() && fanOut->inFlight == 0)
+            {
+                auto callback = std::move(fanOut->callback);
+                callback();
+                return;
+            }
+            startTasks(fanOut);
+        });
+    }
+}
+
+/** @brief The state of an asynchronous batch query */
+struct BatchQuery
+{
+    std::vector<std::string> paths;
+    PathValueMap values;
+    std::function<void(const std::string&, StringCallback)> query;
+    PathValueCallback callback;
+};
+
+/**
+ * @brief Query the PSUs missing from an asynchronous batch query one by one,
+ *        with at most PSU_PROBE_PARALLELISM queries in flight, and complete
+ *        it.
+ */
+void queryMissingAsync(const std::shared_ptr<BatchQuery>& batch)
+{
+    std::vector<std::string> missing;
+    for (const auto& path : batch->paths)
+    {
+        if (!batch->values.contains(path))
+        {
+            missing.push_back(path);
+        }
+    }
+
+    forEachAsync(
+        missing, PSU_PROBE_PARALLELISM,
+        [batch](const std::string& path, DoneCallback done) {
+            batch->query(path, [batch, path, done](std::string value) {
+                batch->values.emplace(path, std::move(value));
+                done();
+            });
+        },
+        [batch]() {
+            auto callback = std::move(batch->callback);
+            callback(std::move(batch->values));
+        });
+}
+
+/**
+ * @brief Asynchronous variant of queryBatch().
+ */
+void queryBatchAsync(
+    std::string_view command, int timeout,
+    const std::vector<std::string>& paths,
+    std::function<void(const std::string&, StringCallback)> query,
+    PathValueCallback callback)
+{
+    auto batch = std::make_shared<BatchQuery>();
+    batch->paths = paths;
+    batch->query = std::move(query);
+    batch->callback = std::move(callback);
+
+    if (!useBatch(command, paths))
+    {
+        queryMissingAsync(batch);
+        return;
+    }
+
+    startAsync(
+        command, makeBatchArgs(paths), makeLimits(timeout, paths.size()),
+        [batch, command = std::string{command}](int rc, std::string output) {
+            PathValueMap values;
+            if (rc == 0)
+            {
+                values = parseBatchOutput(output);
+            }
+            setBatchSupport(command, rc, !values.empty());
+            for (const auto& path : batch->paths)
+            {
+                auto it = values.find(path);
+                if (it != values.end())
+                {
+                    batch->values.emplace(path, std::move(it->second));
+                }
+            }
+            queryMissingAsync(batch);
+        });
+}
+
+using ReplyCallback = std::function<void(sdbusplus::message_t*)>;
+
+/** @brief Handle the reply of an asynchronous D-Bus call */
+int onReply(sd_bus_message* m, void* userdata, sd_bus_error* /* error */)
+{
+    const auto& callback = *static_cast<ReplyCallback*>(userdata);
+    try
+    {
+        if (sd_bus_message_is_method_error(m, nullptr) != 0)
+        {
+            callback(nullptr);
+        }
+        else
+        {
+            sdbusplus::message_t reply(m);
+            callback(&reply);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        // Don't let an exception escape into the event loop
+        lg2::error("Unable to handle D-Bus reply: {ERROR}", "ERROR", e);
+    }
+    return 0;
+}
+
+/**
+ * @brief Call a D-Bus method without waiting for the reply.
+ *
+ * @details The callback is invoked from the event loop with the reply, or with
+ *          nullptr if the method returns an error. If the call cannot be sent
+ *          the callback is invoked immediately with nullptr.
+ *
+ * @param[in] bus      - The Dbus bus object
+ * @param[in] method   - The method call message
+ * @param[in] callback - Invoked with the reply
+ */
+void callAsync(sdbusplus::bus_t& bus, sdbusplus::message_t& method,
+               ReplyCallback callback)
+{
+    auto userdata = std::make_unique<ReplyCallback>(std::move(callback));
+    sd_bus_slot* slot = nullptr;
+    auto rc = sd_bus_call_async(bus.get(), &slot, method.get(), onReply,
+                                userdata.get(), 0);
+    if (rc < 0)
+    {
+        lg2::error("Unable to call D-Bus method {METHOD}: {ERROR}", "METHOD",
+                   method.get_member(), "ERROR", std::strerror(-rc));
+        (*userdata)(nullptr);
+        return;
+    }
+
+    // The bus owns the slot, which frees the callback once it is done
+    sd_bus_slot_set_destroy_callback(slot, [](void* data) {
+        delete static_cast<ReplyCallback*>(data);
+    });
+    userdata.release();
+    sd_bus_slot_set_floating(slot, 1);
+    sd_bus_slot_unref(slot);
+}
+
+/**
+ * @brief Read the Present property of a PSU without waiting for it.
+ *
+ * @param[in] bus      - The Dbus bus object
+ * @param[in] path     - The PSU inventory object path
+ * @param[in] serviceCache - The cache of the services of the objects
+ * @param[in] callback - Invoked with the Present property, or nullopt if it
+ *                       cannot be read
+ */
+void readPresentAsync(sdbusplus::bus_t& bus, const std::string& path,
+                      ServiceCache& serviceCache,
+                      const std::function<void(std::optional<bool>)>& callback)
+{
+    auto onProperty = [callback](sdbusplus::message_t* reply) {
+        std::optional<bool> present;
+        try
+        {
+            if (reply != nullptr)
+            {
+                UtilsInterface::PropertyType value;
+                reply->read(value);
+                present = std::get<bool>(value);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            // Ignore errors; the information might not be available yet
+        }
+        callback(present);
+    };
+
+    auto readProperty = [&bus, path, callback,
+                         onProperty](const std::string& service) {
+        try
+        {
+            auto method = bus.new_method_call(service.c_str(), path.c_str(),
+                                              "org.freedesktop.DBus.Properties",
+                                              "Get");
+            method.append(ITEM_IFACE, PRESENT);
+            callAsync(bus, method, onProperty);
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Unable to get presence of PSU {PSU}: {ERROR}", "PSU",
+                       path, "ERROR", e);
+            callback(std::nullopt);
+        }
+    };
+
+    if (auto services = serviceCache.find(path, ITEM_IFACE))
+    {
+        readProperty(services->front());
+        return;
+    }
+
+    auto onObject = [path, &serviceCache, callback,
+                     readProperty](sdbusplus::message_t* reply) {
+        ServiceCache::Services services;
+        try
+        {
+            if (reply != nullptr)
+            {
+                auto objects = reply->unpack<std::vector<
+                    std::pair<std::string, std::vector<std::string>>>>();
+                for (const auto& object : objects)
+                {
+                    services.push_back(object.first);
+                }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            // Ignore errors; the information might not be available yet
+        }
+        if (services.empty())
+        {
+            callback(std::nullopt);
+            return;
+        }
+        serviceCache.insert(path, ITEM_IFACE, services);
+        readProperty(services.front());
+    };
+
+    try
+    {
+        auto mapper = bus.new_method_call(MAPPER_BUSNAME, MAPPER_PATH,
+                                          MAPPER_INTERFACE, "GetObject");
+        mapper.append(path, std::vector<std::string>({ITEM_IFACE}));
+        callAsync(bus, mapper, onObject);
     }
-    while (fgets(buffer.data(), buffer.size(), pipe) != nullptr)
+    catch (const std::exception& e)
     {
-        result << buffer.data();
+        lg2::error("Unable to get presence of PSU {PSU}: {ERROR}", "PSU", path,
+                   "ERROR", e);
+        callback(std::nullopt);
     }
-    rc = pclose(pipe);
-    return {rc, result.str()};
 }
 
 } // namespace internal
 
+void forEachAsync(const std::vector<std::string>& items, size_t limit,
+                  AsyncTask task, DoneCallback callback)
+{
+    if (items.empty())
+    {
+        callback();
+        return;
+    }
+    auto fanOut = std::make_shared<internal::FanOut>();
+    fanOut->items = items;
+    fanOut->limit = std::max<size_t>(limit, 1);
+    fanOut->task = std::move(task);
+    fanOut->callback = std::move(callback);
+    internal::startTasks(fanOut);
+}
+
+PathValueMap parseBatchOutput(std::string_view output)
+{
+    PathValueMap values;
+    while (!output.empty())
+    {
+        auto end = output.find('\n');
+        auto line = output.substr(0, end);
+        output.remove_prefix(end == std::string_view::npos ? output.size()
+                                                           : end + 1);
+
+        auto sep = line.find(' ');
+        if (!line.starts_with('/') || sep == std::string_view::npos)
+        {
+            continue;
+        }
+        values.emplace(line.substr(0, sep), line.substr(sep + 1));
+    }
+    return values;
+}
+
+PathValueMap queryBatch(
+    std::string_view command, int timeout,
+    const std::vector<std::string>& paths,
+    const std::function<std::string(const std::string&)>& query)
+{
+    PathValueMap output;
+    if (internal::useBatch(command, paths))
+    {
+        int status = Subprocess::limitExceeded;
+        try
+        {
+            auto [rc, out] = internal::exec(
+                command, internal::makeBatchArgs(paths),
+                internal::makeLimits(timeout, paths.size()));
+            status = rc;
+            if (rc == 0)
+            {
+                output = parseBatchOutput(out);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Unable to execute command {CMD}: {ERROR}", "CMD",
+                       command, "ERROR", e);
+        }
+        internal::setBatchSupport(command, status, !output.empty());
+    }
+
+    PathValueMap values;
+    for (const auto& path : paths)
+    {
+        auto it = output.find(path);
+        values.emplace(path, it != output.end() ? std::move(it->second)
+                                                : query(path));
+    }
+    return values;
+}
+
 const UtilsInterface& getUtils()
 {
-    static Utils utils;
-    return utils;
+    static const auto utils = []() -> std::unique_ptr<UtilsInterface> {
+        constexpr std::string_view plugin = PSU_PLUGIN;
+        if (!plugin.empty())
+        {
+            try
+            {
+                return std::make_unique<PluginUtils>(std::string{plugin});
+            }
+            catch (const std::exception& e)
+            {
+                lg2::error("Unable to use PSU plugin: {ERROR}", "ERROR", e);
+            }
+        }
+
+        constexpr std::string_view helper = PSU_HELPER_UTIL;
+        if (!helper.empty())
+        {
+            try
+            {
+                return std::make_unique<HelperUtils>(
+                    internal::getEvent(), helper,
+                    std::chrono::seconds(PSU_HELPER_TIMEOUT));
+            }
+            catch (const std::exception& e)
+            {
+                lg2::error("Unable to use PSU helper: {ERROR}", "ERROR", e);
+            }
+        }
+        return std::make_unique<Utils>();
+    }();
+    return *utils;
 }
 
 std::vector<std::string> Utils::getPSUInventoryPaths(
@@ -107,6 +649,67 @@ std::vector<std::string> Utils::getPSUInventoryPaths(
     return paths;
 }
 
+std::optional<PsuInventoryMap> Utils::getPSUInventory(
+    sdbusplus::bus_t& bus) const
+{
+    using Properties = std::map<std::string, PropertyType>;
+    std::map<sdbusplus::object_path, std::map<std::string, Properties>>
+        objects;
+    try
+    {
+        auto method = bus.new_method_call(INVENTORY_BUSNAME, INVENTORY_OBJPATH,
+                                          "org.freedesktop.DBus.ObjectManager",
+                                          "GetManagedObjects");
+        auto reply = bus.call(method);
+        reply.read(objects);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::info("Unable to get the inventory objects: {ERROR}", "ERROR", e);
+        return std::nullopt;
+    }
+
+    PsuInventoryMap inventory;
+    constexpr std::string_view base = PSU_INVENTORY_PATH_BASE;
+    for (const auto& [objPath, interfaces] : objects)
+    {
+        const std::string& path = objPath.str;
+        if (!path.starts_with(base) ||
+            !interfaces.contains(PSU_INVENTORY_IFACE))
+        {
+            continue;
+        }
+        auto& psu = inventory[path];
+        if (auto item = interfaces.find(ITEM_IFACE); item != interfaces.end())
+        {
+            serviceCache.insert(path, ITEM_IFACE, {INVENTORY_BUSNAME});
+            auto present = item->second.find(PRESENT);
+            if (present != item->second.end() &&
+                std::holds_alternative<bool>(present->second))
+            {
+                psu.present = std::get<bool>(present->second);
+            }
+        }
+        if (auto asset = interfaces.find(ASSET_IFACE);
+            asset != interfaces.end())
+        {
+            serviceCache.insert(path, ASSET_IFACE, {INVENTORY_BUSNAME});
+            auto manufacturer = asset->second.find(MANUFACTURER);
+            if (manufacturer != asset->second.end() &&
+                std::holds_alternative<std::string>(manufacturer->second))
+            {
+                psu.manufacturer = std::get<std::string>(manufacturer->second);
+            }
+        }
+    }
+    if (inventory.empty())
+    {
+        // The PSUs may not be managed by the inventory manager
+        return std::nullopt;
+    }
+    return inventory;
+}
+
 std::string Utils::getService(sdbusplus::bus_t& bus, const char* path,
                               const char* interface) const
 {
@@ -122,6 +725,11 @@ std::string Utils::getService(sdbusplus::bus_t& bus, const char* path,
 std::vector<std::string> Utils::getServices(
     sdbusplus::bus_t& bus, const char* path, const char* interface) const
 {
+    if (auto services = serviceCache.find(path, interface))
+    {
+        return std::move(*services);
+    }
+
     std::vector<std::string> services;
     try
     {
@@ -146,34 +754,46 @@ std::vector<std::string> Utils::getServices(
             std::format("Unable to find services for path {}, interface {}: {}",
                         path, interface, e.what())};
     }
+    serviceCache.insert(path, interface, services);
     return services;
 }
 
-std::string Utils::getVersionId(const std::string& version) const
+void Utils::cacheServices(sdbusplus::bus_t& bus) const
+{
+    serviceCache.watch(bus, PSU_INVENTORY_PATH_BASE);
+}
+
+void Utils::refreshServices() const
+{
+    serviceCache.logStats();
+    serviceCache.clear();
+}
+
+std::optional<VersionId> Utils::getVersionId(std::string_view version) const
 {
     if (version.empty())
     {
         lg2::error("Error version is empty");
-        return {};
+        return std::nullopt;
     }
 
-    using EVP_MD_CTX_Ptr =
-        std::unique_ptr<EVP_MD_CTX, decltype(&::EVP_MD_CTX_free)>;
-
-    std::array<unsigned char, EVP_MAX_MD_SIZE> digest{};
-    EVP_MD_CTX_Ptr ctx(EVP_MD_CTX_new(), &::EVP_MD_CTX_free);
-
-    EVP_DigestInit(ctx.get(), EVP_sha512());
-    EVP_DigestUpdate(ctx.get(), version.c_str(), strlen(version.c_str()));
-    EVP_DigestFinal(ctx.get(), digest.data(), nullptr);
-
-    // Only need 8 hex digits.
-    char mdString[9];
-    snprintf(mdString, sizeof(mdString), "%02x%02x%02x%02x",
-             (unsigned int)digest[0], (unsigned int)digest[1],
-             (unsigned int)digest[2], (unsigned int)digest[3]);
+    auto id = versionIdCache.get(version);
+    if (!id)
+    {
+        lg2::error("Failed to compute the id of version {VERSION}", "VERSION",
+                   std::string(version));
+    }
+    return id;
+}
 
-    return mdString;
+std::optional<VersionId> Utils::getAlternateVersionId(std::string_view version,
+                                                      size_t index) const
+{
+    if (version.empty() || index == 0)
+    {
+        return std::nullopt;
+    }
+    return versionIdCache.compute(version, index);
 }
 
 std::string Utils::getVersion(const std::string& inventoryPath) const
@@ -184,7 +804,9 @@ std::string Utils::getVersion(const std::string& inventoryPath) const
         // Invoke vendor-specific tool to get the version string, e.g.
         //   psutils --get-version
         //   /xyz/openbmc_project/inventory/system/chassis/motherboard/powersupply0
-        auto [rc, output] = internal::exec(PSU_VERSION_UTIL, inventoryPath);
+        auto [rc, output] = internal::exec(
+            PSU_VERSION_UTIL, {inventoryPath},
+            internal::makeLimits(PSU_VERSION_UTIL_TIMEOUT));
         if (rc == 0)
         {
             version = output;
@@ -206,7 +828,9 @@ std::string Utils::getModel(const std::string& inventoryPath) const
         // Invoke vendor-specific tool to get the model string, e.g.
         //   psutils --get-model
         //   /xyz/openbmc_project/inventory/system/chassis/motherboard/powersupply0
-        auto [rc, output] = internal::exec(PSU_MODEL_UTIL, inventoryPath);
+        auto [rc, output] = internal::exec(
+            PSU_MODEL_UTIL, {inventoryPath},
+            internal::makeLimits(PSU_MODEL_UTIL_TIMEOUT));
         if (rc == 0)
         {
             model = output;
@@ -227,13 +851,10 @@ std::string Utils::getLatestVersion(const std::set<std::string>& versions) const
     {
         if (!versions.empty())
         {
-            std::stringstream args;
-            for (const auto& s : versions)
-            {
-                args << s << " ";
-            }
-            auto [rc, output] =
-                internal::exec(PSU_VERSION_COMPARE_UTIL, args.str());
+            std::vector<std::string> args(versions.begin(), versions.end());
+            auto [rc, output] = internal::exec(
+                PSU_VERSION_COMPARE_UTIL, args,
+                internal::makeLimits(PSU_VERSION_COMPARE_UTIL_TIMEOUT));
             if (rc == 0)
             {
                 latestVersion = output;
@@ -248,13 +869,95 @@ std::string Utils::getLatestVersion(const std::set<std::string>& versions) const
     return latestVersion;
 }
 
-bool Utils::isAssociated(const std::string& psuInventoryPath,
-                         const AssociationList& assocs) const
+void Utils::getVersionAsync(const std::string& inventoryPath,
+                            StringCallback callback) const
+{
+    internal::execAsync(PSU_VERSION_UTIL, {inventoryPath},
+                        internal::makeLimits(PSU_VERSION_UTIL_TIMEOUT),
+                        std::move(callback));
+}
+
+void Utils::getModelAsync(const std::string& inventoryPath,
+                          StringCallback callback) const
+{
+    internal::execAsync(PSU_MODEL_UTIL, {inventoryPath},
+                        internal::makeLimits(PSU_MODEL_UTIL_TIMEOUT),
+                        std::move(callback));
+}
+
+void Utils::getLatestVersionAsync(const std::set<std::string>& versions,
+                                  StringCallback callback) const
+{
+    if (versions.empty())
+    {
+        callback({});
+        return;
+    }
+    std::vector<std::string> args(versions.begin(), versions.end());
+    internal::execAsync(PSU_VERSION_COMPARE_UTIL, args,
+                        internal::makeLimits(PSU_VERSION_COMPARE_UTIL_TIMEOUT),
+                        std::move(callback));
+}
+
+PathValueMap Utils::getVersions(
+    const std::vector<std::string>& inventoryPaths) const
+{
+    return queryBatch(
+        PSU_VERSION_UTIL, PSU_VERSION_UTIL_TIMEOUT, inventoryPaths,
+        [this](const std::string& path) { return getVersion(path); });
+}
+
+PathValueMap Utils::getModels(
+    const std::vector<std::string>& inventoryPaths) const
+{
+    return queryBatch(
+        PSU_MODEL_UTIL, PSU_MODEL_UTIL_TIMEOUT, inventoryPaths,
+        [this](const std::string& path) { return getModel(path); });
+}
+
+void Utils::getVersionsAsync(const std::vector<std::string>& inventoryPaths,
+                             PathValueCallback callback) const
+{
+    internal::queryBatchAsync(
+        PSU_VERSION_UTIL, PSU_VERSION_UTIL_TIMEOUT, inventoryPaths,
+        [this](const std::string& path, StringCallback cb) {
+            getVersionAsync(path, std::move(cb));
+        },
+        std::move(callback));
+}
+
+void Utils::getModelsAsync(const std::vector<std::string>& inventoryPaths,
+                           PathValueCallback callback) const
+{
+    internal::queryBatchAsync(
+        PSU_MODEL_UTIL, PSU_MODEL_UTIL_TIMEOUT, inventoryPaths,
+        [this](const std::string& path, StringCallback cb) {
+            getModelAsync(path, std::move(cb));
+        },
+        std::move(callback));
+}
+
+void Utils::getPresentAsync(sdbusplus::bus_t& bus,
+                            const std::vector<std::string>& inventoryPaths,
+                            PathPresentCallback callback) const
 {
-    return std::find_if(assocs.begin(), assocs.end(),
-                        [&psuInventoryPath](const auto& assoc) {
-                            return psuInventoryPath == std::get<2>(assoc);
-                        }) != assocs.end();
+    auto values = std::make_shared<PathPresentMap>();
+    forEachAsync(
+        inventoryPaths, PSU_PROBE_PARALLELISM,
+        [this, &bus, values](const std::string& path, DoneCallback done) {
+            internal::readPresentAsync(
+                bus, path, serviceCache,
+                [values, path, done](std::optional<bool> present) {
+                    if (present)
+                    {
+                        values->emplace(path, *present);
+                    }
+                    done();
+                });
+        },
+        [values, callback = std::move(callback)]() {
+            callback(std::move(*values));
+        });
 }
 
 any Utils::getPropertyImpl(sdbusplus::bus_t& bus, const char* service,
@@ -1,12 +1,21 @@
 #pragma once
 
-#include "types.hpp"
+#include "config.h"
+
+#include "service_cache.hpp"
+#include "version_id.hpp"
+#include "version_id_cache.hpp"
 
 #include <sdbusplus/bus.hpp>
 
 #include <any>
+#include <exception>
+#include <functional>
+#include <map>
+#include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace utils
@@ -14,7 +23,25 @@ namespace utils
 
 class UtilsInterface;
 
-using AssociationList = phosphor::software::updater::AssociationList;
+using StringCallback = std::function<void(std::string)>;
+using PathValueMap = std::map<std::string, std::string>;
+using PathValueCallback = std::function<void(PathValueMap)>;
+using PathPresentMap = std::map<std::string, bool>;
+using PathPresentCallback = std::function<void(PathPresentMap)>;
+using DoneCallback = std::function<void()>;
+
+/** @brief The inventory properties of a PSU */
+struct PsuInventory
+{
+    /** @brief The Present property, if the object implements Item */
+    std::optional<bool> present;
+
+    /** @brief The Manufacturer property, if the object implements Asset */
+    std::optional<std::string> manufacturer;
+};
+using PsuInventoryMap = std::map<std::string, PsuInventory>;
+
+using AsyncTask = std::function<void(const std::string&, DoneCallback)>;
 using std::any;
 using std::any_cast;
 
@@ -35,6 +62,19 @@ const UtilsInterface& getUtils();
  */
 std::vector<std::string> getPSUInventoryPaths(sdbusplus::bus_t& bus);
 
+/** @brief Get the inventory properties of all PSUs
+ *
+ * @details Reads the objects of the inventory manager with a single
+ *          GetManagedObjects call, and caches their services.
+ *
+ * @param[in] bus - The Dbus bus object
+ *
+ * @return The map of PSU inventory path to its properties, or nullopt if the
+ *         inventory manager does not implement ObjectManager or does not
+ *         manage the PSUs
+ */
+std::optional<PsuInventoryMap> getPSUInventory(sdbusplus::bus_t& bus);
+
 /** @brief Get service name from object path and interface
  *
  *  @details Throws an exception if an error occurs or no service name was
@@ -63,6 +103,23 @@ std::string getService(sdbusplus::bus_t& bus, const char* path,
 std::vector<std::string> getServices(sdbusplus::bus_t& bus, const char* path,
                                      const char* interface);
 
+/** @brief Cache the services of the Dbus objects
+ *
+ *  @details Once called, getService(), getServices() and getPresentAsync()
+ *           look up the services of the objects under PSU_INVENTORY_PATH_BASE
+ *           in a cache instead of calling the ObjectMapper each time. The
+ *           cache is invalidated by the NameOwnerChanged signals of the cached
+ *           services, and the InterfacesAdded and InterfacesRemoved signals of
+ *           the cached objects.
+ *
+ * @param[in] bus          - The Dbus bus object
+ */
+void cacheServices(sdbusplus::bus_t& bus);
+
+/** @brief Log the statistics of the service cache and clear it
+ */
+void refreshServices();
+
 /** @brief The template function to get property from the requested dbus path
  *
  *  @details Throws an exception if an error occurs
@@ -82,14 +139,30 @@ T getProperty(sdbusplus::bus_t& bus, const char* service, const char* path,
 /**
  * @brief Calculate the version id from the version string.
  *
- * @details The version id is a unique 8 hexadecimal digit id
- *          calculated from the version string.
+ * @details The version id is a 32-bit id calculated from the version
+ *          string, formatted as 8 hexadecimal digits. Distinct versions may
+ *          get the same id, see getAlternateVersionId().
  *
  * @param[in] version - The image version string (e.g. v1.99.10-19).
  *
- * @return The id.
+ * @return The id, or nullopt if the version is empty.
  */
-std::string getVersionId(const std::string& version);
+std::optional<VersionId> getVersionId(std::string_view version);
+
+/**
+ * @brief Get an alternate version id, for a version whose id collides
+ *
+ * @details The alternate ids are taken from the following words of the
+ *          digest, so each version has the same sequence of ids.
+ *
+ * @param[in] version - The image version string.
+ * @param[in] index - The index of the alternate id, from 1.
+ *
+ * @return The id, or nullopt if the version is empty or there is no
+ *         alternate id of the index.
+ */
+std::optional<VersionId> getAlternateVersionId(std::string_view version,
+                                               size_t index);
 
 /** @brief Get version of PSU specified by the inventory path
  *
@@ -107,6 +180,125 @@ std::string getVersion(const std::string& inventoryPath);
  */
 std::string getModel(const std::string& inventoryPath);
 
+/** @brief Get version of PSU specified by the inventory path asynchronously
+ *
+ * @param[in] inventoryPath - The PSU inventory object path
+ * @param[in] callback - Invoked with the version string, or empty string if it
+ *                       fails to get the version
+ */
+void getVersionAsync(const std::string& inventoryPath,
+                     StringCallback callback);
+
+/** @brief Get model of PSU specified by the inventory path asynchronously
+ *
+ * @param[in] inventoryPath - The PSU inventory object path
+ * @param[in] callback - Invoked with the model string, or empty string if it
+ *                       fails to get the model
+ */
+void getModelAsync(const std::string& inventoryPath, StringCallback callback);
+
+/** @brief Get versions of the PSUs specified by the inventory paths
+ *
+ * @details Queries all PSUs with a single invocation of the version tool if
+ *          it supports the batch protocol, and falls back to one invocation
+ *          per PSU otherwise.
+ *
+ * @param[in] inventoryPaths - The PSU inventory object paths
+ *
+ * @return The map of inventory path to version string; the version string is
+ *         empty if it fails to get the version of that PSU
+ */
+PathValueMap getVersions(const std::vector<std::string>& inventoryPaths);
+
+/** @brief Get models of the PSUs specified by the inventory paths
+ *
+ * @details Queries all PSUs with a single invocation of the model tool if it
+ *          supports the batch protocol, and falls back to one invocation per
+ *          PSU otherwise.
+ *
+ * @param[in] inventoryPaths - The PSU inventory object paths
+ *
+ * @return The map of inventory path to model string; the model string is
+ *         empty if it fails to get the model of that PSU
+ */
+PathValueMap getModels(const std::vector<std::string>& inventoryPaths);
+
+/** @brief Asynchronous variant of getVersions()
+ *
+ * @param[in] inventoryPaths - The PSU inventory object paths
+ * @param[in] callback - Invoked with the map of inventory path to version
+ */
+void getVersionsAsync(const std::vector<std::string>& inventoryPaths,
+                      PathValueCallback callback);
+
+/** @brief Asynchronous variant of getModels()
+ *
+ * @param[in] inventoryPaths - The PSU inventory object paths
+ * @param[in] callback - Invoked with the map of inventory path to model
+ */
+void getModelsAsync(const std::vector<std::string>& inventoryPaths,
+                    PathValueCallback callback);
+
+/** @brief Get whether the PSUs are present asynchronously
+ *
+ * @details Looks up the services of the inventory objects and reads their
+ *          Present properties concurrently, with at most
+ *          PSU_PROBE_PARALLELISM D-Bus calls in flight.
+ *
+ * @param[in] bus - The Dbus bus object
+ * @param[in] inventoryPaths - The PSU inventory object paths
+ * @param[in] callback - Invoked with the map of inventory path to Present
+ *                       property; the PSUs whose property cannot be read are
+ *                       missing from the map
+ */
+void getPresentAsync(sdbusplus::bus_t& bus,
+                     const std::vector<std::string>& inventoryPaths,
+                     PathPresentCallback callback);
+
+/** @brief Run an asynchronous task for each item, with a bounded number of
+ *         tasks in flight
+ *
+ * @details The tasks are started in order. A task may invoke its callback
+ *          before returning.
+ *
+ * @param[in] items - The items to run the task for
+ * @param[in] limit - The maximum number of tasks in flight
+ * @param[in] task - Started for each item; invokes its callback once done
+ * @param[in] callback - Invoked once all tasks are done
+ */
+void forEachAsync(const std::vector<std::string>& items, size_t limit,
+                  AsyncTask task, DoneCallback callback);
+
+/** @brief Parse the output of a vendor tool invoked in batch mode
+ *
+ * @details Each line of the output is a record of the PSU inventory path and
+ *          its value, separated by a single space. Lines that do not start
+ *          with an object path are ignored.
+ *
+ * @param[in] output - The output of the vendor tool
+ *
+ * @return The map of inventory path to value
+ */
+PathValueMap parseBatchOutput(std::string_view output);
+
+/** @brief Query the values of several PSUs from a vendor tool
+ *
+ * @details Tries a single batch invocation first, unless the tool is known
+ *          not to support the batch mode. The PSUs missing from its output
+ *          are then queried one by one.
+ *
+ * @param[in] command - The configured vendor tool
+ * @param[in] timeout - The configured timeout of the tool in seconds
+ * @param[in] paths   - The PSU inventory paths
+ * @param[in] query   - Queries the value of a single PSU
+ *
+ * @return The map of inventory path to value
+ */
+PathValueMap queryBatch(
+    std::string_view command, int timeout,
+    const std::vector<std::string>& paths,
+    const std::function<std::string(const std::string&)>& query);
+
 /** @brief Get latest version from the PSU versions
  *
  * @param[in] versions - The list of the versions
@@ -116,15 +308,14 @@ std::string getModel(const std::string& inventoryPath);
  */
 std::string getLatestVersion(const std::set<std::string>& versions);
 
-/** @brief Check if the PSU is associated
- *
- * @param[in] psuInventoryPath - The PSU inventory path
- * @param[in] assocs - The list of associations
+/** @brief Get latest version from the PSU versions asynchronously
  *
- * @return true if the psu is in the association list
+ * @param[in] versions - The list of the versions
+ * @param[in] callback - Invoked with the latest version string, or empty
+ *                       string if it fails to get the latest version
  */
-bool isAssociated(const std::string& psuInventoryPath,
-                  const AssociationList& assocs);
+void getLatestVersionAsync(const std::set<std::string>& versions,
+                           StringCallback callback);
 
 /**
  * @brief The interface for utils
@@ -146,6 +337,17 @@ class UtilsInterface
     virtual std::vector<std::string> getPSUInventoryPaths(
         sdbusplus::bus_t& bus) const = 0;
 
+    /** @brief Get the inventory properties of all PSUs
+     *
+     *  @details The default implementation returns nullopt, so the
+     *           properties are read object by object.
+     */
+    virtual std::optional<PsuInventoryMap> getPSUInventory(
+        sdbusplus::bus_t& /*bus*/) const
+    {
+        return std::nullopt;
+    }
+
     virtual std::string getService(sdbusplus::bus_t& bus, const char* path,
                                    const char* interface) const = 0;
 
@@ -153,7 +355,19 @@ class UtilsInterface
         sdbusplus::bus_t& bus, const char* path,
         const char* interface) const = 0;
 
-    virtual std::string getVersionId(const std::string& version) const = 0;
+    virtual std::optional<VersionId> getVersionId(
+        std::string_view version) const = 0;
+
+    virtual std::optional<VersionId> getAlternateVersionId(
+        std::string_view version, size_t index) const = 0;
+
+    /** @brief Cache the services of the Dbus objects
+     *
+     *  @details The default implementation does not cache.
+     */
+    virtual void cacheServices(sdbusplus::bus_t& /*bus*/) const {}
+
+    virtual void refreshServices() const {}
 
     virtual std::string getVersion(const std::string& inventoryPath) const = 0;
 
@@ -162,8 +376,94 @@ class UtilsInterface
     virtual std::string getLatestVersion(
         const std::set<std::string>& versions) const = 0;
 
-    virtual bool isAssociated(const std::string& psuInventoryPath,
-                              const AssociationList& assocs) const = 0;
+    /** @brief Asynchronous variants of the vendor tool queries
+     *
+     *  @details The default implementations call the synchronous variant and
+     *           invoke the callback before returning.
+     */
+    virtual void getVersionAsync(const std::string& inventoryPath,
+                                 StringCallback callback) const
+    {
+        callback(getVersion(inventoryPath));
+    }
+
+    virtual void getModelAsync(const std::string& inventoryPath,
+                               StringCallback callback) const
+    {
+        callback(getModel(inventoryPath));
+    }
+
+    virtual void getLatestVersionAsync(const std::set<std::string>& versions,
+                                       StringCallback callback) const
+    {
+        callback(getLatestVersion(versions));
+    }
+
+    /** @brief Batched variants of the vendor tool queries
+     *
+     *  @details The default implementations query the PSUs one by one.
+     */
+    virtual PathValueMap getVersions(
+        const std::vector<std::string>& inventoryPaths) const
+    {
+        PathValueMap values;
+        for (const auto& path : inventoryPaths)
+        {
+            values.emplace(path, getVersion(path));
+        }
+        return values;
+    }
+
+    virtual PathValueMap getModels(
+        const std::vector<std::string>& inventoryPaths) const
+    {
+        PathValueMap values;
+        for (const auto& path : inventoryPaths)
+        {
+            values.emplace(path, getModel(path));
+        }
+        return values;
+    }
+
+    virtual void getVersionsAsync(
+        const std::vector<std::string>& inventoryPaths,
+        PathValueCallback callback) const
+    {
+        callback(getVersions(inventoryPaths));
+    }
+
+    virtual void getModelsAsync(const std::vector<std::string>& inventoryPaths,
+                                PathValueCallback callback) const
+    {
+        callback(getModels(inventoryPaths));
+    }
+
+    /** @brief Get whether the PSUs are present asynchronously
+     *
+     *  @details The default implementation reads the properties one by one
+     *           and invokes the callback before returning.
+     */
+    virtual void getPresentAsync(sdbusplus::bus_t& bus,
+                                 const std::vector<std::string>& inventoryPaths,
+                                 PathPresentCallback callback) const
+    {
+        PathPresentMap values;
+        for (const auto& path : inventoryPaths)
+        {
+            try
+            {
+                auto service = getService(bus, path.c_str(), ITEM_IFACE);
+                values.emplace(path, getProperty<bool>(bus, service.c_str(),
+                                                       path.c_str(), ITEM_IFACE,
+                                                       PRESENT));
+            }
+            catch (const std::exception& e)
+            {
+                // Ignore errors; the information might not be available yet
+            }
+        }
+        callback(std::move(values));
+    }
 
     virtual any getPropertyImpl(sdbusplus::bus_t& bus, const char* service,
                                 const char* path, const char* interface,
@@ -186,6 +486,9 @@ class Utils : public UtilsInterface
     std::vector<std::string> getPSUInventoryPaths(
         sdbusplus::bus_t& bus) const override;
 
+    std::optional<PsuInventoryMap> getPSUInventory(
+        sdbusplus::bus_t& bus) const override;
+
     std::string getService(sdbusplus::bus_t& bus, const char* path,
                            const char* interface) const override;
 
@@ -193,7 +496,15 @@ class Utils : public UtilsInterface
                                          const char* path,
                                          const char* interface) const override;
 
-    std::string getVersionId(const std::string& version) const override;
+    std::optional<VersionId> getVersionId(
+        std::string_view version) const override;
+
+    std::optional<VersionId> getAlternateVersionId(
+        std::string_view version, size_t index) const override;
+
+    void cacheServices(sdbusplus::bus_t& bus) const override;
+
+    void refreshServices() const override;
 
     std::string getVersion(const std::string& inventoryPath) const override;
 
@@ -202,12 +513,41 @@ class Utils : public UtilsInterface
     std::string getLatestVersion(
         const std::set<std::string>& versions) const override;
 
-    bool isAssociated(const std::string& psuInventoryPath,
-                      const AssociationList& assocs) const override;
+    void getVersionAsync(const std::string& inventoryPath,
+                         StringCallback callback) const override;
+
+    void getModelAsync(const std::string& inventoryPath,
+                       StringCallback callback) const override;
+
+    void getLatestVersionAsync(const std::set<std::string>& versions,
+                               StringCallback callback) const override;
+
+    PathValueMap getVersions(
+        const std::vector<std::string>& inventoryPaths) const override;
+
+    PathValueMap getModels(
+        const std::vector<std::string>& inventoryPaths) const override;
+
+    void getVersionsAsync(const std::vector<std::string>& inventoryPaths,
+                          PathValueCallback callback) const override;
+
+    void getModelsAsync(const std::vector<std::string>& inventoryPaths,
+                        PathValueCallback callback) const override;
+
+    void getPresentAsync(sdbusplus::bus_t& bus,
+                         const std::vector<std::string>& inventoryPaths,
+                         PathPresentCallback callback) const override;
 
     any getPropertyImpl(sdbusplus::bus_t& bus, const char* service,
                         const char* path, const char* interface,
                         const char* propertyName) const override;
+
+  private:
+    /** @brief The cache of the services of the Dbus objects */
+    mutable ServiceCache serviceCache;
+
+    /** @brief The memoized ids of the versions */
+    mutable VersionIdCache versionIdCache;
 };
 
 inline std::string getService(sdbusplus::bus_t& bus, const char* path,
@@ -222,16 +562,37 @@ inline std::vector<std::string> getServices(
     return getUtils().getServices(bus, path, interface);
 }
 
+inline void cacheServices(sdbusplus::bus_t& bus)
+{
+    getUtils().cacheServices(bus);
+}
+
+inline void refreshServices()
+{
+    getUtils().refreshServices();
+}
+
 inline std::vector<std::string> getPSUInventoryPaths(sdbusplus::bus_t& bus)
 {
     return getUtils().getPSUInventoryPaths(bus);
 }
 
-inline std::string getVersionId(const std::string& version)
+inline std::optional<PsuInventoryMap> getPSUInventory(sdbusplus::bus_t& bus)
+{
+    return getUtils().getPSUInventory(bus);
+}
+
+inline std::optional<VersionId> getVersionId(std::string_view version)
 {
     return getUtils().getVersionId(version);
 }
 
+inline std::optional<VersionId> getAlternateVersionId(std::string_view version,
+                                                      size_t index)
+{
+    return getUtils().getAlternateVersionId(version, index);
+}
+
 inline std::string getVersion(const std::string& inventoryPath)
 {
     return getUtils().getVersion(inventoryPath);
@@ -247,10 +608,51 @@ inline std::string getLatestVersion(const std::set<std::string>& versions)
     return getUtils().getLatestVersion(versions);
 }
 
-inline bool isAssociated(const std::string& psuInventoryPath,
-                         const AssociationList& assocs)
+inline void getVersionAsync(const std::string& inventoryPath,
+                            StringCallback callback)
+{
+    getUtils().getVersionAsync(inventoryPath, std::move(callback));
+}
+
+inline void getModelAsync(const std::string& inventoryPath,
+                          StringCallback callback)
+{
+    getUtils().getModelAsync(inventoryPath, std::move(callback));
+}
+
+inline void getLatestVersionAsync(const std::set<std::string>& versions,
+                                  StringCallback callback)
+{
+    getUtils().getLatestVersionAsync(versions, std::move(callback));
+}
+
+inline PathValueMap getVersions(const std::vector<std::string>& inventoryPaths)
+{
+    return getUtils().getVersions(inventoryPaths);
+}
+
+inline PathValueMap getModels(const std::vector<std::string>& inventoryPaths)
+{
+    return getUtils().getModels(inventoryPaths);
+}
+
+inline void getVersionsAsync(const std::vector<std::string>& inventoryPaths,
+                             PathValueCallback callback)
+{
+    getUtils().getVersionsAsync(inventoryPaths, std::move(callback));
+}
+
+inline void getModelsAsync(const std::vector<std::string>& inventoryPaths,
+                           PathValueCallback callback)
+{
+    getUtils().getModelsAsync(inventoryPaths, std::move(callback));
+}
+
+inline void getPresentAsync(sdbusplus::bus_t& bus,
+                            const std::vector<std::string>& inventoryPaths,
+                            PathPresentCallback callback)
 {
-    return getUtils().isAssociated(psuInventoryPath, assocs);
+    getUtils().getPresentAsync(bus, inventoryPaths, std::move(callback));
 }
 
 template <typename T>
@@ -2,6 +2,10 @@
 
 #include "config.h"
 
+#include "interned_path.hpp"
+#include "slot_map.hpp"
+#include "version_id.hpp"
+
 #include <sdbusplus/bus.hpp>
 #include <xyz/openbmc_project/Object/Delete/server.hpp>
 #include <xyz/openbmc_project/Software/Version/server.hpp>
@@ -13,7 +17,7 @@ namespace software
 namespace updater
 {
 
-using eraseFunc = std::function<void(std::string)>;
+using eraseFunc = std::function<void(utils::SlotHandle)>;
 
 using VersionInherit = sdbusplus::server::object_t<
     sdbusplus::xyz::openbmc_project::Software::server::Version>;
@@ -68,17 +72,19 @@ class Version : public VersionInherit
      * @param[in] bus            - The D-Bus bus object
      * @param[in] objPath        - The D-Bus object path
      * @param[in] versionId      - The version Id
+     * @param[in] handle         - The handle of the software of the version
      * @param[in] versionString  - The version string
      * @param[in] versionPurpose - The version purpose
      * @param[in] callback       - The eraseFunc callback
      */
     Version(sdbusplus::bus_t& bus, const std::string& objPath,
-            const std::string& versionId, const std::string& versionString,
-            VersionPurpose versionPurpose, eraseFunc callback) :
+            utils::VersionId versionId, utils::SlotHandle handle,
+            const std::string& versionString, VersionPurpose versionPurpose,
+            eraseFunc callback) :
         VersionInherit(bus, (objPath).c_str(),
                        VersionInherit::action::defer_emit),
         eraseCallback(std::move(callback)), objPath(objPath),
-        versionId(versionId), versionStr(versionString)
+        versionId(versionId), handle(handle), versionStr(versionString)
     {
         // Set properties.
         purpose(versionPurpose);
@@ -93,44 +99,18 @@ class Version : public VersionInherit
     /**
      * @brief Return the version id
      */
-    std::string getVersionId() const
+    utils::VersionId getVersionId() const
     {
         return versionId;
     }
 
     /**
-     * @brief Read the manifest file to get the values of the keys.
-     *
-     * @param[in] filePath - The path to the file which contains the value
-     *                       of keys.
-     * @param[in] keys     - A vector of keys.
-     *
-     * @return The map of keys with filled values.
-     **/
-    static std::map<std::string, std::string> getValues(
-        const std::string& filePath, const std::vector<std::string>& keys);
-
-    /**
-     * @brief Read the manifest file to get the value of the key.
-     *
-     * @param[in] filePath - The path to the file which contains the value
-     *                       of keys.
-     * @param[in] key      - The string of the key.
-     *
-     * @return The string of the value.
-     **/
-    static std::string getValue(const std::string& filePath,
-                                const std::string& key);
-
-    /** @brief Get information from extVersion
-     *
-     * @param[in] extVersion - The extended version string that contains
-     *                         key/value pairs separated by comma.
-     *
-     * @return The map of key/value pairs
+     * @brief Return the handle of the software of the version
      */
-    static std::map<std::string, std::string> getExtVersionInfo(
-        const std::string& extVersion);
+    utils::SlotHandle getHandle() const
+    {
+        return handle;
+    }
 
     /** @brief The temUpdater's erase callback. */
     eraseFunc eraseCallback;
@@ -143,10 +123,13 @@ class Version : public VersionInherit
 
   private:
     /** @brief Persistent DBus object path */
-    std::string objPath;
+    utils::InternedPath objPath;
 
     /** @brief This Version's version Id */
-    const std::string versionId;
+    const utils::VersionId versionId;
+
+    /** @brief The handle of the software of this Version */
+    const utils::SlotHandle handle;
 
     /** @brief This Version's version string */
     const std::string versionStr;
@@ -0,0 +1,344 @@
+#include "config.h"
+
+#include "version_compare.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <exception>
+#include <vector>
+
+namespace utils
+{
+
+namespace // anonymous
+{
+
+/** @brief Three-way compare two values */
+template <typename T>
+int cmp(const T& a, const T& b)
+{
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+bool isDigit(char c)
+{
+    return std::isdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+/** @brief Compare two strings of digits by their numeric values */
+int compareDigits(std::string_view a, std::string_view b)
+{
+    a.remove_prefix(std::min(a.find_first_not_of('0'), a.size()));
+    b.remove_prefix(std::min(b.find_first_not_of('0'), b.size()));
+    if (a.size() != b.size())
+    {
+        return cmp(a.size(), b.size());
+    }
+    return a.compare(b);
+}
+
+/** @brief Compare runs of digits numerically and other characters as-is */
+int compareNumeric(std::string_view a, std::string_view b)
+{
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.size() && j < b.size())
+    {
+        if (isDigit(a[i]) && isDigit(b[j]))
+        {
+            auto endA = std::find_if_not(a.begin() + i, a.end(), isDigit) -
+                        a.begin();
+            auto endB = std::find_if_not(b.begin() + j, b.end(), isDigit) -
+                        b.begin();
+            auto rc = compareDigits(a.substr(i, endA - i),
+                                    b.substr(j, endB - j));
+            if (rc != 0)
+            {
+                return rc;
+            }
+            i = endA;
+            j = endB;
+            continue;
+        }
+        if (a[i] != b[j])
+        {
+            return cmp(a[i], b[j]);
+        }
+        ++i;
+        ++j;
+    }
+    return cmp(a.size() - i, b.size() - j);
+}
+
+/** @brief A parsed semantic version */
+struct SemVer
+{
+    std::string_view major;
+    std::string_view minor;
+    std::string_view patch;
+    std::vector<std::string_view> preRelease;
+};
+
+bool isNumber(std::string_view s)
+{
+    return !s.empty() && std::all_of(s.begin(), s.end(), isDigit);
+}
+
+/** @brief Split the string on the separator */
+std::vector<std::string_view> split(std::string_view s, char sep)
+{
+    std::vector<std::string_view> fields;
+    size_t pos = 0;
+    while (true)
+    {
+        auto end = s.find(sep, pos);
+        fields.push_back(s.substr(pos, end - pos));
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+        pos = end + 1;
+    }
+    return fields;
+}
+
+/** @brief Parse a semantic version, with an optional leading 'v' */
+std::optional<SemVer> parseSemVer(std::string_view s)
+{
+    if (s.starts_with('v') || s.starts_with('V'))
+    {
+        s.remove_prefix(1);
+    }
+    // Build metadata does not affect precedence
+    s = s.substr(0, s.find('+'));
+
+    SemVer v;
+    auto dash = s.find('-');
+    if (dash != std::string_view::npos)
+    {
+        v.preRelease = split(s.substr(dash + 1), '.');
+        if (std::ranges::any_of(v.preRelease,
+                                [](auto id) { return id.empty(); }))
+        {
+            return std::nullopt;
+        }
+        s = s.substr(0, dash);
+    }
+
+    auto core = split(s, '.');
+    if (core.size() != 3 || !std::ranges::all_of(core, isNumber))
+    {
+        return std::nullopt;
+    }
+    v.major = core[0];
+    v.minor = core[1];
+    v.patch = core[2];
+    return v;
+}
+
+/** @brief Compare as semantic versions; invalid versions are the oldest */
+int compareSemVer(std::string_view a, std::string_view b)
+{
+    auto va = parseSemVer(a);
+    auto vb = parseSemVer(b);
+    if (!va || !vb)
+    {
+        return !va && !vb ? compareNumeric(a, b) : (va ? 1 : -1);
+    }
+
+    for (auto [x, y] : {std::pair{va->major, vb->major},
+                        std::pair{va->minor, vb->minor},
+                        std::pair{va->patch, vb->patch}})
+    {
+        if (auto rc = compareDigits(x, y); rc != 0)
+        {
+            return rc;
+        }
+    }
+
+    // A pre-release is older than the release
+    if (va->preRelease.empty() || vb->preRelease.empty())
+    {
+        return cmp(va->preRelease.empty(), vb->preRelease.empty());
+    }
+    for (size_t i = 0; i < va->preRelease.size() && i < vb->preRelease.size();
+         ++i)
+    {
+        auto x = va->preRelease[i];
+        auto y = vb->preRelease[i];
+        int rc = 0;
+        if (isNumber(x) && isNumber(y))
+        {
+            rc = compareDigits(x, y);
+        }
+        else if (isNumber(x) || isNumber(y))
+        {
+            // Numeric identifiers are older than alphanumeric ones
+            rc = isNumber(x) ? -1 : 1;
+        }
+        else
+        {
+            rc = x.compare(y);
+        }
+        if (rc != 0)
+        {
+            return rc;
+        }
+    }
+    return cmp(va->preRelease.size(), vb->preRelease.size());
+}
+
+/** @brief Parse a hexadecimal revision, with an optional 0x prefix */
+std::optional<std::string> parseHex(std::string_view s)
+{
+    if (s.starts_with("0x") || s.starts_with("0X"))
+    {
+        s.remove_prefix(2);
+    }
+    if (s.empty() || !std::all_of(s.begin(), s.end(), [](char c) {
+            return std::isxdigit(static_cast<unsigned char>(c)) != 0;
+        }))
+    {
+        return std::nullopt;
+    }
+    s.remove_prefix(std::min(s.find_first_not_of('0'), s.size()));
+    std::string hex(s);
+    std::ranges::transform(hex, hex.begin(), [](char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    });
+    return hex;
+}
+
+/** @brief Compare as hexadecimal revisions; invalid versions are the oldest */
+int compareHex(std::string_view a, std::string_view b)
+{
+    auto ha = parseHex(a);
+    auto hb = parseHex(b);
+    if (!ha || !hb)
+    {
+        return !ha && !hb ? a.compare(b) : (ha ? 1 : -1);
+    }
+    if (ha->size() != hb->size())
+    {
+        return cmp(ha->size(), hb->size());
+    }
+    return ha->compare(*hb);
+}
+
+/** @brief Compare the captured groups in order; versions that do not match
+ *         are the oldest */
+int compareRegex(const std::regex& pattern, std::string_view a,
+                 std::string_view b)
+{
+    std::match_results<std::string_view::const_iterator> ma;
+    std::match_results<std::string_view::const_iterator> mb;
+    bool matchA = std::regex_match(a.begin(), a.end(), ma, pattern);
+    bool matchB = std::regex_match(b.begin(), b.end(), mb, pattern);
+    if (!matchA || !matchB)
+    {
+        return !matchA && !matchB ? compareNumeric(a, b) : (matchA ? 1 : -1);
+    }
+    for (size_t i = 1; i < ma.size(); ++i)
+    {
+        std::string_view x(ma[i].first, ma[i].second);
+        std::string_view y(mb[i].first, mb[i].second);
+        if (auto rc = compareNumeric(x, y); rc != 0)
+        {
+            return rc;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+std::optional<VersionScheme> toVersionScheme(std::string_view name)
+{
+    if (name == "util")
+    {
+        return VersionScheme::util;
+    }
+    if (name == "numeric")
+    {
+        return VersionScheme::numeric;
+    }
+    if (name == "semver")
+    {
+        return VersionScheme::semver;
+    }
+    if (name == "hex")
+    {
+        return VersionScheme::hex;
+    }
+    if (name == "regex")
+    {
+        return VersionScheme::regex;
+    }
+    return std::nullopt;
+}
+
+VersionCompare::VersionCompare(VersionScheme scheme,
+                               const std::string& pattern) :
+    versionScheme(scheme)
+{
+    if (scheme == VersionScheme::regex)
+    {
+        this->pattern = std::make_shared<const std::regex>(pattern);
+    }
+}
+
+VersionCompare VersionCompare::fromConfig()
+{
+    std::string name = PSU_VERSION_COMPARE;
+    std::string pattern = PSU_VERSION_COMPARE_REGEX;
+    if (const auto* env = std::getenv("PSU_VERSION_COMPARE"))
+    {
+        name = env;
+    }
+    if (const auto* env = std::getenv("PSU_VERSION_COMPARE_REGEX"))
+    {
+        pattern = env;
+    }
+
+    auto scheme = toVersionScheme(name);
+    if (!scheme)
+    {
+        lg2::error("Unknown PSU version compare scheme {SCHEME}", "SCHEME",
+                   name);
+        return VersionCompare{};
+    }
+    try
+    {
+        return VersionCompare{*scheme, pattern};
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Invalid PSU version compare regex {REGEX}: {ERROR}",
+                   "REGEX", pattern, "ERROR", e);
+        return VersionCompare{};
+    }
+}
+
+int VersionCompare::compare(std::string_view a, std::string_view b) const
+{
+    switch (versionScheme)
+    {
+        case VersionScheme::numeric:
+            return compareNumeric(a, b);
+        case VersionScheme::semver:
+            return compareSemVer(a, b);
+        case VersionScheme::hex:
+            return compareHex(a, b);
+        case VersionScheme::regex:
+            return compareRegex(*pattern, a, b);
+        case VersionScheme::util:
+            break;
+    }
+    // The order is decided by PSU_VERSION_COMPARE_UTIL
+    return a.compare(b);
+}
+
+} // namespace utils
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+
+namespace utils
+{
+
+/** @brief The schemes to compare PSU versions */
+enum class VersionScheme
+{
+    /** Run PSU_VERSION_COMPARE_UTIL to find the latest version */
+    util,
+    /** Compare runs of digits numerically and other characters as-is */
+    numeric,
+    /** Compare as semantic versions, e.g. 1.2.3-rc1 */
+    semver,
+    /** Compare as hexadecimal revisions, e.g. 0x01A3 */
+    hex,
+    /** Compare the groups captured by PSU_VERSION_COMPARE_REGEX in order */
+    regex,
+};
+
+/** @brief Get the scheme from its name, or nullopt if it is unknown */
+std::optional<VersionScheme> toVersionScheme(std::string_view name);
+
+/** @class VersionCompare
+ *  @brief Compares PSU versions in-process.
+ *  @details It is a strict weak ordering that can be used as the comparator
+ *           of ordered containers. Versions that the scheme considers equal
+ *           are ordered by their strings, so that distinct version strings
+ *           are never equivalent.
+ */
+class VersionCompare
+{
+  public:
+    using is_transparent = void;
+
+    /** @brief Constructs VersionCompare
+     *  @details Throws an exception if the scheme is regex and the pattern is
+     *           not a valid regular expression.
+     *
+     * @param[in] scheme  - The scheme to compare versions with
+     * @param[in] pattern - The regular expression for the regex scheme
+     */
+    explicit VersionCompare(VersionScheme scheme = VersionScheme::util,
+                            const std::string& pattern = {});
+
+    /** @brief Constructs the VersionCompare selected by the build options
+     *  @details The PSU_VERSION_COMPARE and PSU_VERSION_COMPARE_REGEX
+     *           environment variables override the build options.
+     */
+    static VersionCompare fromConfig();
+
+    /** @brief Compare two versions
+     *
+     * @return A negative value, 0 or a positive value if a is older than,
+     *         the same as or newer than b
+     */
+    int compare(std::string_view a, std::string_view b) const;
+
+    /** @brief Whether version a is ordered before version b */
+    bool operator()(std::string_view a, std::string_view b) const
+    {
+        auto rc = compare(a, b);
+        return rc != 0 ? rc < 0 : a < b;
+    }
+
+    /** @brief The scheme to compare versions with */
+    VersionScheme scheme() const
+    {
+        return versionScheme;
+    }
+
+  private:
+    /** @brief The scheme to compare versions with */
+    VersionScheme versionScheme;
+
+    /** @brief The regular expression for the regex scheme */
+    std::shared_ptr<const std::regex> pattern;
+};
+
+} // namespace utils
@@ -0,0 +1,32 @@
+#include "config.h"
+
+#include "version_id.hpp"
+
+#include <charconv>
+#include <format>
+
+namespace utils
+{
+
+std::optional<VersionId> VersionId::parse(std::string_view str)
+{
+    uint32_t value = 0;
+    const auto* end = str.data() + str.size();
+    if (str.size() != digits || str.front() == '+' || str.front() == '-')
+    {
+        return std::nullopt;
+    }
+    auto [ptr, ec] = std::from_chars(str.data(), end, value, 16);
+    if (ec != std::errc() || ptr != end)
+    {
+        return std::nullopt;
+    }
+    return VersionId(value);
+}
+
+std::string VersionId::str() const
+{
+    return std::format("{:08x}", id);
+}
+
+} // namespace utils
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace utils
+{
+
+/** @class VersionId
+ *  @brief The ID of a software version, as a 32-bit value.
+ *  @details The ID is formatted as 8 lowercase hexadecimal digits, the last
+ *           element of the D-Bus object path of the version.
+ */
+class VersionId
+{
+  public:
+    /** @brief The number of hexadecimal digits of the formatted ID */
+    static constexpr size_t digits = 8;
+
+    constexpr VersionId() = default;
+
+    /** @brief Constructs VersionId from its value */
+    constexpr explicit VersionId(uint32_t value) : id(value) {}
+
+    /** @brief Parse a formatted ID
+     *
+     * @param[in] str - The ID, as 8 hexadecimal digits
+     *
+     * @return The ID, or nullopt if the string is not a valid ID
+     */
+    static std::optional<VersionId> parse(std::string_view str);
+
+    /** @brief Format the ID as 8 lowercase hexadecimal digits */
+    std::string str() const;
+
+    /** @brief Get the value of the ID */
+    constexpr uint32_t value() const
+    {
+        return id;
+    }
+
+    constexpr auto operator<=>(const VersionId&) const = default;
+
+  private:
+    /** @brief The value of the ID */
+    uint32_t id{0};
+};
+
+} // namespace utils
+
+template <>
+struct std::hash<utils::VersionId>
+{
+    size_t operator()(const utils::VersionId& versionId) const noexcept
+    {
+        return std::hash<uint32_t>{}(versionId.value());
+    }
+};
@@ -0,0 +1,71 @@
+#include "config.h"
+
+#include "version_id_cache.hpp"
+
+#include <array>
+
+namespace utils
+{
+
+static_assert((VersionIdCache::maxIndex + 1) * 4 <= EVP_MAX_MD_SIZE);
+
+VersionIdCache::VersionIdCache() :
+    md(EVP_MD_fetch(nullptr, "SHA512", nullptr), &::EVP_MD_free),
+    ctx(EVP_MD_CTX_new(), &::EVP_MD_CTX_free)
+{}
+
+std::optional<VersionId> VersionIdCache::get(std::string_view version)
+{
+    if (version.empty())
+    {
+        return std::nullopt;
+    }
+
+    auto it = ids.find(version);
+    if (it != ids.end())
+    {
+        ++hitCount;
+        return it->second;
+    }
+    ++missCount;
+
+    auto id = compute(version);
+    if (id)
+    {
+        if (ids.size() >= maxEntries)
+        {
+            ids.clear();
+        }
+        ids.emplace(version, *id);
+    }
+    return id;
+}
+
+std::optional<VersionId> VersionIdCache::compute(std::string_view version,
+                                                 size_t index)
+{
+    if (index > maxIndex)
+    {
+        return std::nullopt;
+    }
+
+    std::array<unsigned char, EVP_MAX_MD_SIZE> digest{};
+
+    // The context keeps its allocations across the digests, and the
+    // algorithm is fetched once
+    if (!md || !ctx || EVP_DigestInit_ex(ctx.get(), md.get(), nullptr) != 1 ||
+        EVP_DigestUpdate(ctx.get(), version.data(), version.size()) != 1 ||
+        EVP_DigestFinal_ex(ctx.get(), digest.data(), nullptr) != 1)
+    {
+        return std::nullopt;
+    }
+
+    // Only need 8 hex digits.
+    const auto* word = &digest[index * 4];
+    return VersionId(static_cast<uint32_t>(word[0]) << 24 |
+                     static_cast<uint32_t>(word[1]) << 16 |
+                     static_cast<uint32_t>(word[2]) << 8 |
+                     static_cast<uint32_t>(word[3]));
+}
+
+} // namespace utils
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "version_id.hpp"
+
+#include <openssl/evp.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace utils
+{
+
+/** @class VersionIdCache
+ *  @brief Computes the version ids, memoizing them by version string.
+ *  @details The same few versions are hashed for each PSU and each stored
+ *           image on every scan, so the ids are kept once computed, and a
+ *           single digest context is reused for the misses. The number of
+ *           entries is bounded, as the versions reported by the PSUs are not
+ *           trusted to be few.
+ */
+class VersionIdCache
+{
+  public:
+    /** @brief The maximum number of memoized versions */
+    static constexpr size_t maxEntries = 64;
+
+    /** @brief The number of alternate ids of a version, taken from the
+     *  following words of the digest */
+    static constexpr size_t maxIndex = 15;
+
+    VersionIdCache();
+
+    /** @brief Get the id of a version
+     *
+     * @param[in] version - The version string
+     *
+     * @return The id, or nullopt if the version is empty or cannot be hashed
+     */
+    std::optional<VersionId> get(std::string_view version);
+
+    /** @brief Compute the id of a version, without memoizing it
+     *  @details The id of index 0 is the first 4 bytes of the SHA-512 of the
+     *           version, and the alternate id of index N the 4 bytes at
+     *           offset 4 * N, up to maxIndex.
+     *
+     * @param[in] version - The version string
+     * @param[in] index - The index of the id
+     *
+     * @return The id, or nullopt if the version cannot be hashed or the index
+     *         is out of range
+     */
+    std::optional<VersionId> compute(std::string_view version,
+                                     size_t index = 0);
+
+    /** @brief The number of memoized versions */
+    size_t size() const
+    {
+        return ids.size();
+    }
+
+    /** @brief The number of lookups served from the cache */
+    uint64_t hits() const
+    {
+        return hitCount;
+    }
+
+    /** @brief The number of ids that were computed */
+    uint64_t misses() const
+    {
+        return missCount;
+    }
+
+  private:
+    /** @brief Hashes the strings and string views alike, for heterogeneous
+     *  lookups */
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view str) const noexcept
+        {
+            return std::hash<std::string_view>{}(str);
+        }
+    };
+
+    /** @brief The SHA-512 algorithm */
+    std::unique_ptr<EVP_MD, decltype(&::EVP_MD_free)> md;
+
+    /** @brief The reused SHA-512 context */
+    std::unique_ptr<EVP_MD_CTX, decltype(&::EVP_MD_CTX_free)> ctx;
+
+    /** @brief The map of the version strings and their ids */
+    std::unordered_map<std::string, VersionId, StringHash, std::equal_to<>>
+        ids;
+
+    /** @brief The number of lookups served from the cache */
+    uint64_t hitCount{0};
+
+    /** @brief The number of ids that were computed */
+    uint64_t missCount{0};
+};
+
+} // namespace utils
@@ -0,0 +1,94 @@
+#include "config.h"
+
+#include "version_id_registry.hpp"
+
+#include "utils.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+namespace utils
+{
+
+std::optional<VersionId> VersionIdRegistry::find(
+    const std::string& version) const
+{
+    auto it = ids.find(version);
+    if (it == ids.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+const std::string* VersionIdRegistry::findVersion(VersionId id) const
+{
+    auto it = versions.find(id);
+    if (it == versions.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+std::optional<VersionId> VersionIdRegistry::resolve(
+    const std::string& version) const
+{
+    if (version.empty())
+    {
+        return std::nullopt;
+    }
+    if (auto id = find(version))
+    {
+        return id;
+    }
+
+    auto id = getVersionId(version);
+    for (size_t index = 1; id; ++index)
+    {
+        const auto* other = findVersion(*id);
+        if (other == nullptr)
+        {
+            return id;
+        }
+        lg2::warning("Version id {VERSION_ID} of {VERSION} is in use by "
+                     "{OTHER}, trying alternate id {INDEX}",
+                     "VERSION_ID", id->str(), "VERSION", version, "OTHER",
+                     *other, "INDEX", index);
+        id = getAlternateVersionId(version, index);
+    }
+
+    lg2::error("No version id available for {VERSION}", "VERSION", version);
+    return std::nullopt;
+}
+
+bool VersionIdRegistry::insert(const std::string& version, VersionId id)
+{
+    auto [it, inserted] = versions.try_emplace(id, version);
+    if (!inserted && it->second != version)
+    {
+        lg2::error("Version id {VERSION_ID} of {VERSION} is in use by "
+                   "{OTHER}",
+                   "VERSION_ID", id.str(), "VERSION", version, "OTHER",
+                   it->second);
+        return false;
+    }
+    ids.insert_or_assign(version, id);
+    return true;
+}
+
+void VersionIdRegistry::erase(VersionId id)
+{
+    auto it = versions.find(id);
+    if (it == versions.end())
+    {
+        return;
+    }
+    auto iti = ids.find(it->second);
+    if (iti != ids.end() && iti->second == id)
+    {
+        ids.erase(iti);
+    }
+    versions.erase(it);
+}
+
+} // namespace utils
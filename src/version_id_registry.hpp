@@ -0,0 +1,86 @@
+#pragma once
+
+#include "version_id.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace utils
+{
+
+/** @class VersionIdRegistry
+ *  @brief The version ids in use, and the versions they were assigned to.
+ *  @details The version ids are truncated hashes, so two versions may get the
+ *           same id. The registry detects it when an id is resolved, and
+ *           gives the later version the first of its alternate ids that is
+ *           not in use. The versions that do not collide keep their usual id,
+ *           and an id stays assigned to its version until it is erased.
+ *
+ *           Which of two colliding versions gets the usual id depends on the
+ *           order they are resolved in, so their ids, and the D-Bus paths of
+ *           their objects, are only stable within one run of the service.
+ *           An id is not reassigned while in use, as its objects would move.
+ */
+class VersionIdRegistry
+{
+  public:
+    /** @brief Get the id assigned to a version
+     *
+     * @param[in] version - The version string
+     *
+     * @return The id, or nullopt if the version has none
+     */
+    std::optional<VersionId> find(const std::string& version) const;
+
+    /** @brief Get the version an id is assigned to
+     *
+     * @param[in] id - The version id
+     *
+     * @return The version, or nullptr if the id is not in use
+     */
+    const std::string* findVersion(VersionId id) const;
+
+    /** @brief Get the id to assign to a version
+     *  @details This is the id already assigned to the version, else its
+     *           usual id if it is not in use, else the first alternate id that
+     *           is not in use.
+     *
+     * @param[in] version - The version string
+     *
+     * @return The id, or nullopt if the version is empty or all of its ids
+     *         are in use
+     */
+    std::optional<VersionId> resolve(const std::string& version) const;
+
+    /** @brief Assign an id to a version
+     *
+     * @param[in] version - The version string
+     * @param[in] id - The version id
+     *
+     * @return false if the id is assigned to another version
+     */
+    bool insert(const std::string& version, VersionId id);
+
+    /** @brief Release an id
+     *
+     * @param[in] id - The version id
+     */
+    void erase(VersionId id);
+
+    /** @brief The number of ids in use */
+    size_t size() const
+    {
+        return versions.size();
+    }
+
+  private:
+    /** @brief The map of the versions and their ids */
+    std::unordered_map<std::string, VersionId> ids;
+
+    /** @brief The map of the ids in use and their versions */
+    std::unordered_map<VersionId, std::string> versions;
+};
+
+} // namespace utils
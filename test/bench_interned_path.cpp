@@ -0,0 +1,100 @@
+#include "interned_path.hpp"
+
+#include <malloc.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <memory>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+constexpr int psus = 64;
+constexpr int versions = 200;
+
+std::string psuPath(int i)
+{
+    return "/xyz/openbmc_project/inventory/system/chassis/motherboard/"
+           "powersupply" +
+           std::to_string(i);
+}
+
+std::string objPath(int i)
+{
+    return "/xyz/openbmc_project/software/" + std::to_string(10000000 + i);
+}
+
+/** The structures holding paths with 64 PSUs and 200 versions: the PSU cache
+ * and the PSU to activation map, then for each activation its object path,
+ * the one of its version, the updating PSU, and a queue and a target set of
+ * all PSUs */
+template <typename Path>
+struct Load
+{
+    std::map<Path, int, std::less<>> cache;
+    std::map<Path, int, std::less<>> activations;
+    std::vector<Path> objPaths;
+    std::vector<Path> updating;
+    std::vector<std::queue<Path>> queues{versions};
+    std::vector<std::set<Path>> targets{versions};
+
+    explicit Load(int first)
+    {
+        for (int i = 0; i < psus; ++i)
+        {
+            cache.emplace(psuPath(i), 0);
+            activations.emplace(psuPath(i), 0);
+        }
+        for (int v = 0; v < versions; ++v)
+        {
+            objPaths.emplace_back(objPath(first + v));
+            objPaths.emplace_back(objPath(first + v));
+            updating.emplace_back(psuPath(v % psus));
+            for (int i = 0; i < psus; ++i)
+            {
+                queues[v].emplace(psuPath(i));
+                targets[v].emplace(psuPath(i));
+            }
+        }
+    }
+};
+
+/** The heap in use, in KiB */
+size_t heapKiB()
+{
+    return mallinfo2().uordblks / 1024;
+}
+
+/** Print the heap used by the load */
+template <typename Path>
+void measure(const char* name)
+{
+    auto before = heapKiB();
+    auto load = std::make_unique<Load<Path>>(0);
+    std::printf("%-24s %8zu KiB\n", name, heapKiB() - before);
+}
+
+} // namespace
+
+int main()
+{
+    measure<std::string>("strings");
+    measure<utils::InternedPath>("interned paths");
+
+    // The software objects come and go, e.g. as images are uploaded and
+    // erased, and their paths are released with them
+    auto before = heapKiB();
+    for (int round = 0; round < 100; ++round)
+    {
+        Load<utils::InternedPath> load(round * versions);
+    }
+    std::printf("%-24s %8zu KiB, %zu paths left\n", "after 100 rounds",
+                heapKiB() - before, utils::InternedPath::count());
+    return utils::InternedPath::count() == 0 ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#include "version_id_cache.hpp"
+
+#include <openssl/evp.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/** The versions hashed on a rescan: one per PSU, then one per stored image */
+const std::vector<std::string> rescan = {
+    "01.02.03", "01.02.03", "01.02.03", "01.02.03", "01.02.03",
+    "01.02.03", "01.02.04", "01.02.04", "01.02.04", "01.02.05"};
+
+constexpr int iterations = 20000;
+
+/** The id computed with a new digest context for each call */
+std::optional<utils::VersionId> computeWithNewContext(
+    const std::string& version)
+{
+    using EVP_MD_CTX_Ptr =
+        std::unique_ptr<EVP_MD_CTX, decltype(&::EVP_MD_CTX_free)>;
+
+    std::array<unsigned char, EVP_MAX_MD_SIZE> digest{};
+    EVP_MD_CTX_Ptr ctx(EVP_MD_CTX_new(), &::EVP_MD_CTX_free);
+
+    EVP_DigestInit(ctx.get(), EVP_sha512());
+    EVP_DigestUpdate(ctx.get(), version.data(), version.size());
+    EVP_DigestFinal(ctx.get(), digest.data(), nullptr);
+
+    return utils::VersionId(static_cast<uint32_t>(digest[0]) << 24 |
+                            static_cast<uint32_t>(digest[1]) << 16 |
+                            static_cast<uint32_t>(digest[2]) << 8 |
+                            static_cast<uint32_t>(digest[3]));
+}
+
+/** Print the average time of a rescan, and return a checksum of the ids so
+ * that they are not optimized away */
+template <typename F>
+uint32_t measure(const char* name, F&& getVersionId)
+{
+    uint32_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        for (const auto& version : rescan)
+        {
+            checksum ^= getVersionId(version)->value();
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+    std::printf("%-24s %8lld ns/rescan\n", name,
+                static_cast<long long>(elapsed.count() / iterations));
+    return checksum;
+}
+
+} // namespace
+
+int main()
+{
+    utils::VersionIdCache cache;
+    auto before = measure("new context", computeWithNewContext);
+    auto reused = measure("reused context", [&cache](const auto& version) {
+        return cache.compute(version);
+    });
+    auto memoized = measure("memoized", [&cache](const auto& version) {
+        return cache.get(version);
+    });
+    return before == reused && before == memoized ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+#include "version_id_registry.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+constexpr size_t smallCount = 1000;
+constexpr size_t largeCount = 120000;
+constexpr size_t lookups = 1000000;
+
+std::vector<std::string> makeVersions(size_t count)
+{
+    std::vector<std::string> versions;
+    versions.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        versions.push_back("version-" + std::to_string(i));
+    }
+    return versions;
+}
+
+/** Print the average time of a lookup in a registry of count versions, and
+ * return a checksum of the ids so that they are not optimized away, or 0 if
+ * a version got no id */
+uint32_t measure(size_t count)
+{
+    auto versions = makeVersions(count);
+    utils::VersionIdRegistry registry;
+    for (const auto& version : versions)
+    {
+        auto id = registry.resolve(version);
+        if (!id || !registry.insert(version, *id))
+        {
+            return 0;
+        }
+    }
+
+    uint32_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; ++i)
+    {
+        const auto& version = versions[i % versions.size()];
+        checksum ^= registry.find(version)->value();
+        checksum ^= registry.findVersion(*registry.find(version))->size();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+    std::printf("%8zu versions %8lld ns/lookup\n", count,
+                static_cast<long long>(elapsed.count() / lookups));
+    return checksum | 1;
+}
+
+} // namespace
+
+int main()
+{
+    auto small = measure(smallCount);
+    auto large = measure(largeCount);
+    return small != 0 && large != 0 ? 0 : 1;
+}
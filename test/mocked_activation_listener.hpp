@@ -16,6 +16,9 @@ class MockedActivationListener : public ActivationListener
 
     ~MockedActivationListener() override = default;
 
-    MOCK_METHOD2(onUpdateDone, void(const std::string& versionId,
+    MOCK_METHOD2(onUpdateDone, void(utils::SlotHandle handle,
                                     const std::string& psuInventoryPath));
+    MOCK_METHOD3(onPathChanged,
+                 void(utils::SlotHandle handle, const std::string& oldPath,
+                      const std::string& newPath));
 };
@@ -21,4 +21,6 @@ class MockedAssociationInterface : public AssociationInterface
     MOCK_METHOD1(addFunctionalAssociation, void(const std::string& path));
     MOCK_METHOD1(addUpdateableAssociation, void(const std::string& path));
     MOCK_METHOD1(removeAssociation, void(const std::string& path));
+    MOCK_METHOD0(beginAssociations, void());
+    MOCK_METHOD0(commitAssociations, void());
 };
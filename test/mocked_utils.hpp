@@ -19,6 +19,9 @@ class MockedUtils : public UtilsInterface
     MOCK_CONST_METHOD1(getPSUInventoryPaths,
                        std::vector<std::string>(sdbusplus::bus_t& bus));
 
+    MOCK_CONST_METHOD1(getPSUInventory, std::optional<PsuInventoryMap>(
+                                            sdbusplus::bus_t& bus));
+
     MOCK_CONST_METHOD3(getService,
                        std::string(sdbusplus::bus_t& bus, const char* path,
                                    const char* interface));
@@ -28,7 +31,12 @@ class MockedUtils : public UtilsInterface
                                                 const char* path,
                                                 const char* interface));
 
-    MOCK_CONST_METHOD1(getVersionId, std::string(const std::string& version));
+    MOCK_CONST_METHOD1(getVersionId,
+                       std::optional<VersionId>(std::string_view version));
+
+    MOCK_CONST_METHOD2(getAlternateVersionId,
+                       std::optional<VersionId>(std::string_view version,
+                                                size_t index));
 
     MOCK_CONST_METHOD1(getVersion,
                        std::string(const std::string& psuInventoryPath));
@@ -39,9 +47,6 @@ class MockedUtils : public UtilsInterface
     MOCK_CONST_METHOD1(getLatestVersion,
                        std::string(const std::set<std::string>& versions));
 
-    MOCK_CONST_METHOD2(isAssociated, bool(const std::string& psuInventoryPath,
-                                          const AssociationList& assocs));
-
     MOCK_CONST_METHOD5(getPropertyImpl,
                        any(sdbusplus::bus_t& bus, const char* service,
                            const char* path, const char* interface,
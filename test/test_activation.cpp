@@ -4,6 +4,7 @@
 #include "mocked_utils.hpp"
 
 #include <sdbusplus/test/sdbus_mock.hpp>
+#include <systemd/sd-event.h>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -42,7 +43,6 @@ class TestActivation : public ::testing::Test
             .WillByDefault(Return(any(PropertyType(std::string("TestManu")))));
         ON_CALL(mockedUtils, getModel(_))
             .WillByDefault(Return(std::string("TestModel")));
-        ON_CALL(mockedUtils, isAssociated(_, _)).WillByDefault(Return(false));
     }
     ~TestActivation() override
     {
@@ -70,16 +70,26 @@ class TestActivation : public ::testing::Test
         return activation->getUpdateService(psuInventoryPath);
     }
 
+    /** The manifest of an image with the extended version */
+    static Manifest makeManifest(const std::string& extVersion)
+    {
+        return Manifest::parse("extended_version=" + extVersion);
+    }
+
     NiceMock<sdbusplus::SdBusMock> sdbusMock;
     sdbusplus::bus_t mockedBus = sdbusplus::get_mocked_new(&sdbusMock);
     const utils::MockedUtils& mockedUtils;
     MockedAssociationInterface mockedAssociationInterface;
     MockedActivationListener mockedActivationListener;
+    PsuCache psuCache{mockedBus};
+    utils::JobDispatcher jobDispatcher{mockedBus};
     std::unique_ptr<Activation> activation;
-    std::string versionId = "abcdefgh";
-    std::string extVersion = "manufacturer=TestManu,model=TestModel";
-    std::string filePath = "/tmp/images/abcdefgh";
-    std::string dBusPath = std::string(SOFTWARE_OBJPATH) + "/" + versionId;
+    utils::VersionId versionId{0xabcdef01};
+    utils::SlotHandle handle{0, 1};
+    Manifest manifest = makeManifest("manufacturer=TestManu,model=TestModel");
+    std::string filePath = "/tmp/images/abcdef01";
+    std::string dBusPath =
+        std::string(SOFTWARE_OBJPATH) + "/" + versionId.str();
     Status status = Status::Ready;
     AssociationList associations;
 };
@@ -87,16 +97,21 @@ class TestActivation : public ::testing::Test
 TEST_F(TestActivation, ctordtor)
 {
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
+    EXPECT_EQ("manufacturer=TestManu,model=TestModel",
+              activation->extendedVersion());
+    EXPECT_EQ("TestModel", activation->getModel());
 }
 
 TEST_F(TestActivation, ctorWithInvalidExtVersion)
 {
-    extVersion = "invalid text";
+    manifest = makeManifest("invalid text");
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
 }
 
 TEST_F(TestActivation, getUpdateService)
@@ -104,12 +119,13 @@ TEST_F(TestActivation, getUpdateService)
     std::string psuInventoryPath = "/com/example/inventory/powersupply1";
     std::string toCompare = "psu-update@-com-example-inventory-"
                             "powersupply1\\x20-tmp-images-12345678.service";
-    versionId = "12345678";
+    versionId = utils::VersionId(0x12345678);
     filePath = "/tmp/images/12345678";
 
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
 
     auto service = getUpdateService(psuInventoryPath);
     EXPECT_EQ(toCompare, service);
@@ -118,8 +134,9 @@ TEST_F(TestActivation, getUpdateService)
 TEST_F(TestActivation, doUpdateWhenNoPSU)
 {
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
     ON_CALL(mockedUtils, getPSUInventoryPaths(_))
         .WillByDefault(
             Return(std::vector<std::string>({}))); // No PSU inventory
@@ -139,8 +156,9 @@ TEST_F(TestActivation, doUpdateOnePSUOK)
 {
     constexpr auto psu0 = "/com/example/inventory/psu0";
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
     ON_CALL(mockedUtils, getPSUInventoryPaths(_))
         .WillByDefault(
             Return(std::vector<std::string>({psu0}))); // One PSU inventory
@@ -148,19 +166,51 @@ TEST_F(TestActivation, doUpdateOnePSUOK)
 
     EXPECT_EQ(Status::Activating, activation->activation());
 
+    EXPECT_CALL(mockedAssociationInterface, beginAssociations()).Times(1);
     EXPECT_CALL(mockedAssociationInterface, createActiveAssociation(dBusPath))
         .Times(1);
     EXPECT_CALL(mockedAssociationInterface, addFunctionalAssociation(dBusPath))
         .Times(1);
     EXPECT_CALL(mockedAssociationInterface, addUpdateableAssociation(dBusPath))
         .Times(1);
-    EXPECT_CALL(mockedActivationListener,
-                onUpdateDone(StrEq(versionId), StrEq(psu0)))
+    EXPECT_CALL(mockedAssociationInterface, commitAssociations()).Times(1);
+    EXPECT_CALL(mockedActivationListener, onUpdateDone(handle, StrEq(psu0)))
         .Times(1);
     onUpdateDone();
     EXPECT_EQ(Status::Active, activation->activation());
 }
 
+TEST_F(TestActivation, doUpdateOnJobRemoved)
+{
+    constexpr auto psu0 = "/com/example/inventory/psu0";
+    constexpr auto psu1 = "/com/example/inventory/psu1";
+    activation = std::make_unique<Activation>(
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
+    ON_CALL(mockedUtils, getPSUInventoryPaths(_))
+        .WillByDefault(Return(std::vector<std::string>({psu0, psu1})));
+    EXPECT_EQ(0U, jobDispatcher.watching());
+    activation->requestedActivation(RequestedStatus::Active);
+
+    // Only the update unit of the current PSU is watched
+    auto unit0 = getUpdateService(psu0);
+    auto unit1 = getUpdateService(psu1);
+    EXPECT_EQ(1U, jobDispatcher.watching());
+    jobDispatcher.dispatch(unit1, "done");
+    EXPECT_EQ(2U, getPsuQueue().size());
+
+    EXPECT_CALL(mockedActivationListener, onUpdateDone(handle, StrEq(psu0)))
+        .Times(1);
+    jobDispatcher.dispatch(unit0, "done");
+    EXPECT_EQ(1U, getPsuQueue().size());
+    EXPECT_EQ(1U, jobDispatcher.watching());
+
+    jobDispatcher.dispatch(unit1, "failed");
+    EXPECT_EQ(Status::Failed, activation->activation());
+    EXPECT_EQ(0U, jobDispatcher.watching());
+}
+
 TEST_F(TestActivation, doUpdateFourPSUsOK)
 {
     constexpr auto psu0 = "/com/example/inventory/psu0";
@@ -168,8 +218,9 @@ TEST_F(TestActivation, doUpdateFourPSUsOK)
     constexpr auto psu2 = "/com/example/inventory/psu2";
     constexpr auto psu3 = "/com/example/inventory/psu3";
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
     ON_CALL(mockedUtils, getPSUInventoryPaths(_))
         .WillByDefault(Return(
             std::vector<std::string>({psu0, psu1, psu2, psu3}))); // 4 PSUs
@@ -178,22 +229,19 @@ TEST_F(TestActivation, doUpdateFourPSUsOK)
     EXPECT_EQ(Status::Activating, activation->activation());
     EXPECT_EQ(10, getProgress());
 
-    EXPECT_CALL(mockedActivationListener,
-                onUpdateDone(StrEq(versionId), StrEq(psu0)))
+    EXPECT_CALL(mockedActivationListener, onUpdateDone(handle, StrEq(psu0)))
         .Times(1);
     onUpdateDone();
     EXPECT_EQ(Status::Activating, activation->activation());
     EXPECT_EQ(30, getProgress());
 
-    EXPECT_CALL(mockedActivationListener,
-                onUpdateDone(StrEq(versionId), StrEq(psu1)))
+    EXPECT_CALL(mockedActivationListener, onUpdateDone(handle, StrEq(psu1)))
         .Times(1);
     onUpdateDone();
     EXPECT_EQ(Status::Activating, activation->activation());
     EXPECT_EQ(50, getProgress());
 
-    EXPECT_CALL(mockedActivationListener,
-                onUpdateDone(StrEq(versionId), StrEq(psu2)))
+    EXPECT_CALL(mockedActivationListener, onUpdateDone(handle, StrEq(psu2)))
         .Times(1);
     onUpdateDone();
     EXPECT_EQ(Status::Activating, activation->activation());
@@ -206,13 +254,65 @@ TEST_F(TestActivation, doUpdateFourPSUsOK)
     EXPECT_CALL(mockedAssociationInterface, addUpdateableAssociation(dBusPath))
         .Times(1);
 
-    EXPECT_CALL(mockedActivationListener,
-                onUpdateDone(StrEq(versionId), StrEq(psu3)))
+    EXPECT_CALL(mockedActivationListener, onUpdateDone(handle, StrEq(psu3)))
         .Times(1);
     onUpdateDone();
     EXPECT_EQ(Status::Active, activation->activation());
 }
 
+TEST_F(TestActivation, doUpdateAssociationsEmittedWhenDone)
+{
+    constexpr auto psu0 = "/com/example/inventory/psu0";
+    constexpr auto psu1 = "/com/example/inventory/psu1";
+    constexpr auto psu2 = "/com/example/inventory/psu2";
+    constexpr auto assocIface = "xyz.openbmc_project.Association.Definitions";
+    sd_event* event = nullptr;
+    ASSERT_LE(0, sd_event_new(&event));
+    ON_CALL(sdbusMock, sd_bus_get_event(_)).WillByDefault(Return(event));
+    activation = std::make_unique<Activation>(
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
+    ON_CALL(mockedUtils, getPSUInventoryPaths(_))
+        .WillByDefault(Return(std::vector<std::string>({psu0, psu1, psu2})));
+    activation->requestedActivation(RequestedStatus::Active);
+
+    // The updated PSUs are stored at once, but only emitted when all are done
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               _, StrEq(dBusPath), StrEq(assocIface), _))
+        .Times(0);
+    onUpdateDone();
+    onUpdateDone();
+    EXPECT_EQ(2U, activation->associations().size());
+
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               _, StrEq(dBusPath), StrEq(assocIface), _))
+        .Times(1);
+    onUpdateDone();
+    EXPECT_EQ(Status::Active, activation->activation());
+    EXPECT_EQ(3U, activation->associations().size());
+    sd_event_unref(event);
+}
+
+TEST_F(TestActivation, removeLastPsuAssociationEmitted)
+{
+    constexpr auto psu0 = "/com/example/inventory/psu0";
+    constexpr auto assocIface = "xyz.openbmc_project.Association.Definitions";
+    associations.emplace_back(ACTIVATION_FWD_ASSOCIATION,
+                              ACTIVATION_REV_ASSOCIATION, psu0);
+    activation = std::make_unique<Activation>(
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
+
+    // The empty list is signalled, so that the mapper drops the association
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               _, StrEq(dBusPath), StrEq(assocIface), _))
+        .Times(1);
+    activation->removePsuAssociation(psu0);
+    EXPECT_TRUE(activation->associations().empty());
+}
+
 TEST_F(TestActivation, doUpdateFourPSUsFailonSecond)
 {
     constexpr auto psu0 = "/com/example/inventory/psu0";
@@ -220,8 +320,9 @@ TEST_F(TestActivation, doUpdateFourPSUsFailonSecond)
     constexpr auto psu2 = "/com/example/inventory/psu2";
     constexpr auto psu3 = "/com/example/inventory/psu3";
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
     ON_CALL(mockedUtils, getPSUInventoryPaths(_))
         .WillByDefault(Return(
             std::vector<std::string>({psu0, psu1, psu2, psu3}))); // 4 PSUs
@@ -230,8 +331,7 @@ TEST_F(TestActivation, doUpdateFourPSUsFailonSecond)
     EXPECT_EQ(Status::Activating, activation->activation());
     EXPECT_EQ(10, getProgress());
 
-    EXPECT_CALL(mockedActivationListener,
-                onUpdateDone(StrEq(versionId), StrEq(psu0)))
+    EXPECT_CALL(mockedActivationListener, onUpdateDone(handle, StrEq(psu0)))
         .Times(1);
     onUpdateDone();
     EXPECT_EQ(Status::Activating, activation->activation());
@@ -252,8 +352,9 @@ TEST_F(TestActivation, doUpdateOnExceptionFromDbus)
 {
     constexpr auto psu0 = "/com/example/inventory/psu0";
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
     ON_CALL(mockedUtils, getPSUInventoryPaths(_))
         .WillByDefault(
             Return(std::vector<std::string>({psu0}))); // One PSU inventory
@@ -268,8 +369,9 @@ TEST_F(TestActivation, doUpdateOnePSUNotPresent)
 {
     constexpr auto psu0 = "/com/example/inventory/psu0";
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
     ON_CALL(mockedUtils, getPSUInventoryPaths(_))
         .WillByDefault(Return(std::vector<std::string>({psu0})));
     ON_CALL(mockedUtils, getPropertyImpl(_, _, _, _, StrEq(PRESENT)))
@@ -279,13 +381,93 @@ TEST_F(TestActivation, doUpdateOnePSUNotPresent)
     EXPECT_EQ(Status::Ready, activation->activation());
 }
 
+TEST_F(TestActivation, doUpdateBeforeInventoryIsIndexed)
+{
+    constexpr auto psu0 = "/com/example/inventory/psu0";
+    constexpr auto psu1 = "/com/example/inventory/psu1";
+    psuCache.track(psu0);
+    psuCache.setPresent(psu0, true);
+    activation = std::make_unique<Activation>(
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
+    ON_CALL(mockedUtils, getPSUInventoryPaths(_))
+        .WillByDefault(Return(std::vector<std::string>({psu0, psu1})));
+    ON_CALL(mockedUtils, getPropertyImpl(_, _, StrEq(psu1), _, StrEq(PRESENT)))
+        .WillByDefault(Return(any(PropertyType(false))));
+
+    // The inventory snapshot is only taken by ItemUpdater, which owns the
+    // index of the PSU inventory
+    EXPECT_CALL(mockedUtils, getPSUInventory(_)).Times(0);
+    activation->requestedActivation(RequestedStatus::Active);
+    EXPECT_EQ(Status::Activating, activation->activation());
+    EXPECT_EQ(1U, getPsuQueue().size());
+    EXPECT_EQ(nullptr, psuCache.find(psu1));
+}
+
+TEST_F(TestActivation, doUpdateFromInventoryIndex)
+{
+    constexpr auto psu0 = "/com/example/inventory/psu0";
+    constexpr auto psu1 = "/com/example/inventory/psu1";
+    psuCache.track(psu0);
+    psuCache.track(psu1);
+    psuCache.setPresent(psu0, true);
+    psuCache.markSeeded();
+    activation = std::make_unique<Activation>(
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
+
+    // The inventory is not queried
+    EXPECT_CALL(mockedUtils, getPSUInventory(_)).Times(0);
+    EXPECT_CALL(mockedUtils, getPSUInventoryPaths(_)).Times(0);
+    EXPECT_CALL(mockedUtils, getPropertyImpl(_, _, _, _, StrEq(PRESENT)))
+        .Times(0);
+    activation->requestedActivation(RequestedStatus::Active);
+    EXPECT_EQ(Status::Activating, activation->activation());
+    EXPECT_EQ(1U, getPsuQueue().size());
+}
+
+TEST_F(TestActivation, activatePsu)
+{
+    constexpr auto psu0 = "/com/example/inventory/psu0";
+    constexpr auto psu1 = "/com/example/inventory/psu1";
+    psuCache.track(psu0);
+    psuCache.track(psu1);
+    psuCache.setPresent(psu0, true);
+    psuCache.setPresent(psu1, true);
+    psuCache.markSeeded();
+    activation = std::make_unique<Activation>(
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
+
+    // Only the requested PSU is updated
+    EXPECT_CALL(mockedUtils, getModel(StrEq(psu0))).Times(0);
+    activation->activatePsu(psu1);
+    EXPECT_EQ(Status::Activating, activation->activation());
+    EXPECT_EQ(1U, getPsuQueue().size());
+    EXPECT_EQ(psu1, getPsuQueue().front());
+
+    // A PSU requested during the activation is updated once it is done
+    activation->activatePsu(psu0);
+    EXPECT_EQ(1U, getPsuQueue().size());
+    EXPECT_CALL(mockedUtils, getModel(StrEq(psu0)))
+        .WillOnce(Return(std::string("TestModel")));
+    onUpdateDone();
+    EXPECT_EQ(Status::Activating, activation->activation());
+    EXPECT_EQ(1U, getPsuQueue().size());
+    EXPECT_EQ(psu0, getPsuQueue().front());
+}
+
 TEST_F(TestActivation, doUpdateOnePSUModelNotCompatible)
 {
     constexpr auto psu0 = "/com/example/inventory/psu0";
-    extVersion = "manufacturer=TestManu,model=DifferentModel";
+    manifest = makeManifest("manufacturer=TestManu,model=DifferentModel");
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
     ON_CALL(mockedUtils, getPSUInventoryPaths(_))
         .WillByDefault(Return(std::vector<std::string>({psu0})));
     activation->requestedActivation(RequestedStatus::Active);
@@ -296,10 +478,11 @@ TEST_F(TestActivation, doUpdateOnePSUModelNotCompatible)
 TEST_F(TestActivation, doUpdateOnePSUManufactureNotCompatible)
 {
     constexpr auto psu0 = "/com/example/inventory/psu0";
-    extVersion = "manufacturer=DifferentManu,model=TestModel";
+    manifest = makeManifest("manufacturer=DifferentManu,model=TestModel");
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
     ON_CALL(mockedUtils, getPSUInventoryPaths(_))
         .WillByDefault(Return(std::vector<std::string>({psu0})));
     activation->requestedActivation(RequestedStatus::Active);
@@ -311,12 +494,13 @@ TEST_F(TestActivation, doUpdateOnePSUSelfManufactureIsEmpty)
 {
     ON_CALL(mockedUtils, getPropertyImpl(_, _, _, _, StrEq(MANUFACTURER)))
         .WillByDefault(Return(any(PropertyType(std::string("")))));
-    extVersion = "manufacturer=AnyManu,model=TestModel";
+    manifest = makeManifest("manufacturer=AnyManu,model=TestModel");
     // Below is the same as doUpdateOnePSUOK case
     constexpr auto psu0 = "/com/example/inventory/psu0";
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
     ON_CALL(mockedUtils, getPSUInventoryPaths(_))
         .WillByDefault(
             Return(std::vector<std::string>({psu0}))); // One PSU inventory
@@ -343,8 +527,9 @@ TEST_F(TestActivation, doUpdateFourPSUsSecondPSUNotCompatible)
     ON_CALL(mockedUtils, getModel(StrEq(psu1)))
         .WillByDefault(Return(std::string("DifferentModel")));
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
     ON_CALL(mockedUtils, getPSUInventoryPaths(_))
         .WillByDefault(Return(
             std::vector<std::string>({psu0, psu1, psu2, psu3}))); // 4 PSUs
@@ -383,8 +568,9 @@ TEST_F(TestActivation, doUpdateWhenNoFilePathInActiveState)
                              // without file path
     constexpr auto psu0 = "/com/example/inventory/psu0";
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
 
     ON_CALL(mockedUtils, getPSUInventoryPaths(_))
         .WillByDefault(
@@ -406,8 +592,9 @@ TEST_F(TestActivation, doUpdateWhenNoFilePathInReadyState)
                             // but we are testing this case as well
     constexpr auto psu0 = "/com/example/inventory/psu0";
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
 
     ON_CALL(mockedUtils, getPSUInventoryPaths(_))
         .WillByDefault(
@@ -426,9 +613,12 @@ TEST_F(TestActivation, doUpdateWhenPSUIsAssociated)
 {
     constexpr auto psu0 = "/com/example/inventory/psu0";
     status = Status::Active; // Typically, a running PSU software is associated
+    associations.emplace_back(ACTIVATION_FWD_ASSOCIATION,
+                              ACTIVATION_REV_ASSOCIATION, psu0);
     activation = std::make_unique<Activation>(
-        mockedBus, dBusPath, versionId, extVersion, status, associations,
-        filePath, &mockedAssociationInterface, &mockedActivationListener);
+        mockedBus, dBusPath, versionId, handle, manifest, status, associations,
+        filePath, &mockedAssociationInterface, &mockedActivationListener,
+        &psuCache, &jobDispatcher);
 
     ON_CALL(mockedUtils, getPSUInventoryPaths(_))
         .WillByDefault(
@@ -436,8 +626,6 @@ TEST_F(TestActivation, doUpdateWhenPSUIsAssociated)
 
     // When PSU is already associated, there shall be no DBus call to start
     // update service
-    EXPECT_CALL(mockedUtils, isAssociated(StrEq(psu0), _))
-        .WillOnce(Return(true));
     EXPECT_CALL(sdbusMock, sd_bus_message_new_method_call(_, _, _, _, _,
                                                           StrEq("StartUnit")))
         .Times(0);
@@ -0,0 +1,66 @@
+#include "config.h"
+
+#include "association_store.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::software::updater;
+
+namespace
+{
+constexpr auto psu0 = "/com/example/inventory/psu0";
+constexpr auto psu1 = "/com/example/inventory/psu1";
+} // namespace
+
+TEST(AssociationStore, addKeepsInsertionOrder)
+{
+    AssociationStore store;
+    EXPECT_TRUE(store.empty());
+
+    EXPECT_TRUE(store.add(ACTIVATION_FWD_ASSOCIATION,
+                          ACTIVATION_REV_ASSOCIATION, psu1));
+    EXPECT_TRUE(store.add(ACTIVATION_FWD_ASSOCIATION,
+                          ACTIVATION_REV_ASSOCIATION, psu0));
+    EXPECT_FALSE(store.add(ACTIVATION_FWD_ASSOCIATION,
+                           ACTIVATION_REV_ASSOCIATION, psu1));
+    EXPECT_TRUE(
+        store.add(ACTIVE_FWD_ASSOCIATION, ACTIVE_REV_ASSOCIATION, psu1));
+
+    AssociationList expected = {
+        {ACTIVATION_FWD_ASSOCIATION, ACTIVATION_REV_ASSOCIATION, psu1},
+        {ACTIVATION_FWD_ASSOCIATION, ACTIVATION_REV_ASSOCIATION, psu0},
+        {ACTIVE_FWD_ASSOCIATION, ACTIVE_REV_ASSOCIATION, psu1}};
+    EXPECT_EQ(expected, store.list());
+    EXPECT_EQ(3U, store.size());
+
+    EXPECT_TRUE(store.contains(psu0));
+    EXPECT_TRUE(store.contains(ACTIVE_FWD_ASSOCIATION, ACTIVE_REV_ASSOCIATION,
+                               psu1));
+    EXPECT_FALSE(store.contains(ACTIVE_FWD_ASSOCIATION,
+                                ACTIVE_REV_ASSOCIATION, psu0));
+}
+
+TEST(AssociationStore, remove)
+{
+    AssociationStore store(
+        {{ACTIVATION_FWD_ASSOCIATION, ACTIVATION_REV_ASSOCIATION, psu0},
+         {ACTIVE_FWD_ASSOCIATION, ACTIVE_REV_ASSOCIATION, psu0},
+         {ACTIVATION_FWD_ASSOCIATION, ACTIVATION_REV_ASSOCIATION, psu1},
+         {ACTIVATION_FWD_ASSOCIATION, ACTIVATION_REV_ASSOCIATION, psu0}});
+    EXPECT_EQ(3U, store.size());
+
+    // All associations to the endpoint are removed
+    EXPECT_EQ(2U, store.remove(psu0));
+    EXPECT_EQ(0U, store.remove(psu0));
+    EXPECT_FALSE(store.contains(psu0));
+    EXPECT_FALSE(store.contains(ACTIVE_FWD_ASSOCIATION,
+                                ACTIVE_REV_ASSOCIATION, psu0));
+    AssociationList expected = {
+        {ACTIVATION_FWD_ASSOCIATION, ACTIVATION_REV_ASSOCIATION, psu1}};
+    EXPECT_EQ(expected, store.list());
+
+    EXPECT_EQ(1U, store.remove(psu1));
+    EXPECT_TRUE(store.empty());
+    EXPECT_TRUE(store.add(ACTIVATION_FWD_ASSOCIATION,
+                          ACTIVATION_REV_ASSOCIATION, psu1));
+}
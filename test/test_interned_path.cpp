@@ -0,0 +1,63 @@
+#include "interned_path.hpp"
+
+#include <functional>
+#include <map>
+#include <string>
+
+#include <gtest/gtest.h>
+
+using utils::InternedPath;
+
+TEST(InternedPath, sharesEqualPaths)
+{
+    auto count = InternedPath::count();
+    std::string path = "/com/example/inventory/psu0";
+    InternedPath psu0(path);
+    InternedPath other(path);
+    EXPECT_EQ(psu0, other);
+    EXPECT_EQ(&psu0.str(), &other.str());
+    EXPECT_EQ(count + 1, InternedPath::count());
+
+    EXPECT_TRUE(InternedPath().empty());
+    EXPECT_TRUE(InternedPath("").empty());
+    EXPECT_FALSE(psu0.empty());
+    EXPECT_EQ(path, psu0.str());
+}
+
+TEST(InternedPath, ordersByPath)
+{
+    // Interned in the reverse order of the paths
+    InternedPath psu9("/com/example/inventory/psu9");
+    InternedPath psu1("/com/example/inventory/psu1");
+    EXPECT_LT(psu1, psu9);
+    EXPECT_TRUE(psu1 == "/com/example/inventory/psu1");
+
+    // Lookups by string do not intern it
+    std::map<InternedPath, int, std::less<>> map{{psu9, 9}, {psu1, 1}};
+    EXPECT_EQ(psu1, map.begin()->first);
+    auto count = InternedPath::count();
+    EXPECT_EQ(9, map.find(std::string("/com/example/inventory/psu9"))->second);
+    EXPECT_FALSE(map.contains("/com/example/inventory/psu5"));
+    EXPECT_EQ(count, InternedPath::count());
+}
+
+TEST(InternedPath, releasesUnusedPaths)
+{
+    auto count = InternedPath::count();
+    {
+        InternedPath psu0("/com/example/inventory/psu0");
+        auto copy = psu0;
+        InternedPath moved(std::move(copy));
+        EXPECT_EQ(count + 1, InternedPath::count());
+
+        psu0 = InternedPath("/com/example/inventory/psu1");
+        EXPECT_EQ(count + 2, InternedPath::count());
+        EXPECT_EQ("/com/example/inventory/psu0", moved.str());
+    }
+    EXPECT_EQ(count, InternedPath::count());
+
+    // The path is interned again once released
+    InternedPath psu0("/com/example/inventory/psu0");
+    EXPECT_EQ(count + 1, InternedPath::count());
+    EXPECT_EQ("/com/example/inventory/psu0", psu0.str());
+}
@@ -9,11 +9,14 @@
 using namespace phosphor::software::updater;
 using ::testing::_;
 using ::testing::ContainerEq;
+using ::testing::Eq;
+using ::testing::Invoke;
+using ::testing::Mock;
 using ::testing::NiceMock;
 using ::testing::Pointee;
 using ::testing::Return;
-using ::testing::ReturnArg;
 using ::testing::StrEq;
+using ::testing::Throw;
 
 using std::any;
 
@@ -32,7 +35,10 @@ class TestItemUpdater : public ::testing::Test
         mockedUtils(
             reinterpret_cast<const utils::MockedUtils&>(utils::getUtils()))
     {
-        ON_CALL(mockedUtils, getVersionId(_)).WillByDefault(ReturnArg<0>());
+        ON_CALL(mockedUtils, getVersionId(_))
+            .WillByDefault(Invoke(getVersionId));
+        ON_CALL(mockedUtils, getAlternateVersionId(_, _))
+            .WillByDefault(Invoke(getAlternateVersionId));
         ON_CALL(mockedUtils, getPropertyImpl(_, _, _, _, StrEq(PRESENT)))
             .WillByDefault(Return(any(PropertyType(true))));
     }
@@ -42,14 +48,41 @@ class TestItemUpdater : public ::testing::Test
         utils::freeUtils();
     }
 
-    auto& GetActivations() const
+    auto& GetSoftware() const
     {
-        return itemUpdater->activations;
+        return itemUpdater->software;
     }
 
-    static std::string getObjPath(const std::string& versionId)
+    const auto& GetActivation(const std::string& version) const
     {
-        return std::string(dBusPath) + "/" + versionId;
+        auto versionId = itemUpdater->versionIdRegistry.find(version);
+        return itemUpdater->findSoftware(*versionId)->activation;
+    }
+
+    auto* GetPsuCache() const
+    {
+        return &itemUpdater->psuCache;
+    }
+
+    /** In testing the version id is derived from the std::hash of the
+     * version */
+    static std::optional<utils::VersionId> getVersionId(
+        std::string_view version)
+    {
+        return utils::VersionId(
+            static_cast<uint32_t>(std::hash<std::string_view>{}(version)));
+    }
+
+    static std::optional<utils::VersionId> getAlternateVersionId(
+        std::string_view version, size_t index)
+    {
+        return utils::VersionId(getVersionId(version)->value() +
+                                static_cast<uint32_t>(index));
+    }
+
+    static std::string getObjPath(const std::string& version)
+    {
+        return std::string(dBusPath) + "/" + getVersionId(version)->str();
     }
 
     void onPsuInventoryChanged(const std::string& psuPath,
@@ -58,11 +91,36 @@ class TestItemUpdater : public ::testing::Test
         itemUpdater->onPsuInventoryChanged(psuPath, properties);
     }
 
+    void onPSUInterfacesRemoved(const std::string& psuPath,
+                                const std::vector<std::string>& interfaces)
+    {
+        itemUpdater->onPSUInterfacesRemoved(psuPath, interfaces);
+    }
+
     void scanDirectory(const fs::path& p) const
     {
         itemUpdater->scanDirectory(p);
     }
 
+    utils::SlotHandle createSoftware(const std::string& version,
+                                     const std::string& filePath) const
+    {
+        return itemUpdater->createSoftware(
+            getObjPath(version), *getVersionId(version), Manifest{},
+            Activation::Status::Ready, {}, filePath, version);
+    }
+
+    std::optional<utils::VersionId> findVersionId(
+        const std::string& version) const
+    {
+        return itemUpdater->findVersionId(version);
+    }
+
+    std::string getFWVersionFromBuiltinDir() const
+    {
+        return itemUpdater->getFWVersionFromBuiltinDir();
+    }
+
     static constexpr auto dBusPath = SOFTWARE_OBJPATH;
     NiceMock<sdbusplus::SdBusMock> sdbusMock;
     sdbusplus::bus_t mockedBus = sdbusplus::get_mocked_new(&sdbusMock);
@@ -78,6 +136,28 @@ TEST_F(TestItemUpdater, ctordtor)
     itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
 }
 
+TEST_F(TestItemUpdater, IndexesVersionsAndImageSources)
+{
+    itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
+    createSoftware("version0", std::string(IMG_DIR) + "/version0");
+    auto handle1 =
+        createSoftware("version1", std::string(IMG_DIR_BUILTIN) + "/model");
+    EXPECT_EQ(getVersionId("version0"), findVersionId("version0"));
+    EXPECT_EQ("version1", getFWVersionFromBuiltinDir());
+
+    // The uploaded image is stored persistently
+    GetActivation("version0")->path(std::string(IMG_DIR_PERSIST) + "/model");
+    EXPECT_EQ("version1", getFWVersionFromBuiltinDir());
+
+    itemUpdater->erase(handle1);
+    EXPECT_FALSE(findVersionId("version1"));
+    EXPECT_EQ("", getFWVersionFromBuiltinDir());
+
+    // The image is found in the built-in dir
+    GetActivation("version0")->path(std::string(IMG_DIR_BUILTIN) + "/model");
+    EXPECT_EQ("version0", getFWVersionFromBuiltinDir());
+}
+
 TEST_F(TestItemUpdater, NotCreateObjectOnNotPresent)
 {
     constexpr auto psuPath = "/com/example/inventory/psu0";
@@ -130,6 +210,104 @@ TEST_F(TestItemUpdater, CreateOnePSUOnPresent)
     itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
 }
 
+TEST_F(TestItemUpdater, AssociationsEmittedOnce)
+{
+    constexpr auto psuPath = "/com/example/inventory/psu0";
+    constexpr auto version = "version0";
+    std::string objPath = getObjPath(version);
+    ON_CALL(mockedUtils, getPSUInventoryPaths(_))
+        .WillByDefault(Return(std::vector<std::string>({psuPath})));
+    ON_CALL(mockedUtils, getVersion(StrEq(psuPath)))
+        .WillByDefault(Return(std::string(version)));
+    ON_CALL(mockedUtils, getModel(StrEq(psuPath)))
+        .WillByDefault(Return(std::string("dummyModel")));
+
+    // The active, functional and updateable associations of the running
+    // version are emitted at once
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               _, StrEq(dBusPath), _, _))
+        .Times(1);
+    itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
+
+    // So is their removal
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               _, StrEq(dBusPath), _, _))
+        .Times(1);
+    itemUpdater->removeAssociation(objPath);
+
+    // Nothing is emitted for a batch that changes nothing
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               _, StrEq(dBusPath), _, _))
+        .Times(0);
+    itemUpdater->beginAssociations();
+    itemUpdater->createActiveAssociation(objPath);
+    itemUpdater->beginAssociations();
+    itemUpdater->addFunctionalAssociation(objPath);
+    itemUpdater->commitAssociations();
+    itemUpdater->removeAssociation(objPath);
+    itemUpdater->commitAssociations();
+}
+
+TEST_F(TestItemUpdater, CreateOnePSUFromInventorySnapshot)
+{
+    constexpr auto psu0 = "/com/example/inventory/psu0";
+    constexpr auto psu1 = "/com/example/inventory/psu1";
+    constexpr auto version = "version0";
+    std::string objPath = getObjPath(version);
+    utils::PsuInventoryMap inventory;
+    inventory[psu0].present = true;
+    inventory[psu0].manufacturer = "TestManu";
+    inventory[psu1].present = false;
+    EXPECT_CALL(mockedUtils, getPSUInventory(_)).WillOnce(Return(inventory));
+
+    // The presence is not read object by object
+    EXPECT_CALL(mockedUtils, getPSUInventoryPaths(_)).Times(0);
+    EXPECT_CALL(mockedUtils, getService(_, _, _)).Times(0);
+    EXPECT_CALL(mockedUtils, getPropertyImpl(_, _, _, _, _)).Times(0);
+    EXPECT_CALL(mockedUtils, getVersion(StrEq(psu0)))
+        .WillOnce(Return(std::string(version)));
+    EXPECT_CALL(mockedUtils, getModel(StrEq(psu0)))
+        .WillOnce(Return(std::string("dummyModel")));
+    EXPECT_CALL(mockedUtils, getVersion(StrEq(psu1))).Times(0);
+
+    // activation and version object will be added
+    EXPECT_CALL(sdbusMock, sd_bus_emit_object_added(_, StrEq(objPath)))
+        .Times(2);
+    itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
+
+    const auto* entry = GetPsuCache()->find(psu0);
+    ASSERT_NE(nullptr, entry);
+    EXPECT_EQ("TestManu", entry->manufacturer);
+    EXPECT_FALSE(GetPsuCache()->find(psu1)->present);
+}
+
+TEST_F(TestItemUpdater, NotSeededUntilInventoryIsRead)
+{
+    constexpr auto psu0 = "/com/example/inventory/psu0";
+
+    // The inventory is not available yet
+    EXPECT_CALL(mockedUtils, getPSUInventoryPaths(_))
+        .WillOnce(Throw(std::runtime_error("Not ready")));
+    itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
+    EXPECT_FALSE(GetPsuCache()->seeded());
+
+    // The presence of a PSU is not available yet
+    EXPECT_CALL(mockedUtils, getPSUInventoryPaths(_))
+        .WillOnce(Return(std::vector<std::string>({psu0})));
+    EXPECT_CALL(mockedUtils, getService(_, StrEq(psu0), _))
+        .WillOnce(Throw(std::runtime_error("Not ready")));
+    itemUpdater->refresh();
+    EXPECT_FALSE(GetPsuCache()->seeded());
+
+    EXPECT_CALL(mockedUtils, getPSUInventoryPaths(_))
+        .WillOnce(Return(std::vector<std::string>({psu0})));
+    EXPECT_CALL(mockedUtils, getService(_, StrEq(psu0), _))
+        .WillRepeatedly(Return(std::string("com.example.Inventory")));
+    itemUpdater->refresh();
+    EXPECT_TRUE(GetPsuCache()->seeded());
+    EXPECT_TRUE(GetPsuCache()->find(psu0)->present);
+}
+
 TEST_F(TestItemUpdater, CreateTwoPSUsWithSameVersion)
 {
     constexpr auto psu0 = "/com/example/inventory/psu0";
@@ -171,9 +349,9 @@ TEST_F(TestItemUpdater, CreateTwoPSUsWithSameVersion)
     itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
 
     // Verify there is only one activation and it has two associations
-    const auto& activations = GetActivations();
-    EXPECT_EQ(1U, activations.size());
-    const auto& activation = activations.find(version0)->second;
+    const auto& software = GetSoftware();
+    EXPECT_EQ(1U, software.size());
+    const auto& activation = GetActivation(version0);
     const auto& assocs = activation->associations();
     EXPECT_EQ(2U, assocs.size());
     EXPECT_EQ(psu0, std::get<2>(assocs[0]));
@@ -223,19 +401,65 @@ TEST_F(TestItemUpdater, CreateTwoPSUsWithDifferentVersion)
     itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
 
     // Verify there are two activations and each with one association
-    const auto& activations = GetActivations();
-    EXPECT_EQ(2U, activations.size());
-    const auto& activation0 = activations.find(version0)->second;
+    const auto& software = GetSoftware();
+    EXPECT_EQ(2U, software.size());
+    const auto& activation0 = GetActivation(version0);
     const auto& assocs0 = activation0->associations();
     EXPECT_EQ(1U, assocs0.size());
     EXPECT_EQ(psu0, std::get<2>(assocs0[0]));
 
-    const auto& activation1 = activations.find(version1)->second;
+    const auto& activation1 = GetActivation(version1);
     const auto& assocs1 = activation1->associations();
     EXPECT_EQ(1U, assocs1.size());
     EXPECT_EQ(psu1, std::get<2>(assocs1[0]));
 }
 
+TEST_F(TestItemUpdater, CreateTwoObjectsOnTwoPSUsWithCollidingVersionIds)
+{
+    constexpr auto psu0 = "/com/example/inventory/psu0";
+    constexpr auto psu1 = "/com/example/inventory/psu1";
+    constexpr auto service = "com.example.Software.Psu";
+    auto version0 = std::string("version0");
+    auto version1 = std::string("version1");
+    auto objPath0 = getObjPath(version0);
+    auto objPath1 = std::string(dBusPath) + "/" +
+                    getAlternateVersionId(version1, 1)->str();
+
+    // Both versions hash to the same id
+    ON_CALL(mockedUtils, getVersionId(Eq(version1)))
+        .WillByDefault(Return(getVersionId(version0)));
+    EXPECT_CALL(mockedUtils, getAlternateVersionId(Eq(version1), 1));
+
+    EXPECT_CALL(mockedUtils, getPSUInventoryPaths(_))
+        .WillOnce(Return(std::vector<std::string>({psu0, psu1})));
+    EXPECT_CALL(mockedUtils, getService(_, StrEq(psu0), _))
+        .WillOnce(Return(service));
+    EXPECT_CALL(mockedUtils, getService(_, StrEq(psu1), _))
+        .WillOnce(Return(service));
+    EXPECT_CALL(mockedUtils, getVersion(StrEq(psu0)))
+        .WillOnce(Return(std::string(version0)));
+    EXPECT_CALL(mockedUtils, getModel(StrEq(psu0)))
+        .WillOnce(Return(std::string("dummyModel0")));
+    EXPECT_CALL(mockedUtils, getVersion(StrEq(psu1)))
+        .WillOnce(Return(std::string(version1)));
+    EXPECT_CALL(mockedUtils, getModel(StrEq(psu1)))
+        .WillOnce(Return(std::string("dummyModel1")));
+
+    // The later version gets the alternate id
+    EXPECT_CALL(sdbusMock, sd_bus_emit_object_added(_, StrEq(dBusPath)))
+        .Times(1);
+    EXPECT_CALL(sdbusMock, sd_bus_emit_object_added(_, StrEq(objPath0)))
+        .Times(2);
+    EXPECT_CALL(sdbusMock, sd_bus_emit_object_added(_, StrEq(objPath1)))
+        .Times(2);
+    itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
+
+    EXPECT_EQ(2U, GetSoftware().size());
+    EXPECT_EQ(objPath0, GetActivation(version0)->getObjectPath());
+    EXPECT_EQ(objPath1, GetActivation(version1)->getObjectPath());
+    EXPECT_EQ(psu1, std::get<2>(GetActivation(version1)->associations()[0]));
+}
+
 TEST_F(TestItemUpdater, OnOnePSURemoved)
 {
     constexpr auto psuPath = "/com/example/inventory/psu0";
@@ -274,6 +498,42 @@ TEST_F(TestItemUpdater, OnOnePSURemoved)
         .Times(1);
 }
 
+TEST_F(TestItemUpdater, OnOnePSURemovedFromInventory)
+{
+    constexpr auto psu0 = "/com/example/inventory/psu0";
+    constexpr auto psu1 = "/com/example/inventory/psu1";
+    constexpr auto service = "com.example.Software.Psu";
+    constexpr auto version = "version0";
+    std::string objPath = getObjPath(version);
+    EXPECT_CALL(mockedUtils, getPSUInventoryPaths(_))
+        .WillOnce(Return(std::vector<std::string>({psu0, psu1})));
+    ON_CALL(mockedUtils, getService(_, _, _)).WillByDefault(Return(service));
+    ON_CALL(mockedUtils, getVersion(_))
+        .WillByDefault(Return(std::string(version)));
+    ON_CALL(mockedUtils, getModel(_))
+        .WillByDefault(Return(std::string("dummyModel")));
+    itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
+    ASSERT_TRUE(GetPsuCache()->seeded());
+
+    // Other interfaces are ignored
+    onPSUInterfacesRemoved(psu0, {"com.example.Other"});
+    EXPECT_NE(nullptr, GetPsuCache()->find(psu0));
+
+    // The index is updated in memory, without querying the inventory
+    EXPECT_CALL(mockedUtils, getPSUInventoryPaths(_)).Times(0);
+    EXPECT_CALL(sdbusMock, sd_bus_emit_object_removed(_, StrEq(objPath)))
+        .Times(0);
+    onPSUInterfacesRemoved(psu0, {PSU_INVENTORY_IFACE, ITEM_IFACE});
+    EXPECT_EQ(nullptr, GetPsuCache()->find(psu0));
+    EXPECT_NE(nullptr, GetPsuCache()->find(psu1));
+
+    // The activation and version objects are removed with the last PSU
+    EXPECT_CALL(sdbusMock, sd_bus_emit_object_removed(_, StrEq(objPath)))
+        .Times(2);
+    onPSUInterfacesRemoved(psu1, {ITEM_IFACE});
+    EXPECT_TRUE(GetPsuCache()->entries().empty());
+}
+
 TEST_F(TestItemUpdater, OnOnePSUAdded)
 {
     constexpr auto psuPath = "/com/example/inventory/psu0";
@@ -347,12 +607,8 @@ TEST_F(TestItemUpdater, OnOnePSURemovedAndAddedWithLatestVersion)
     EXPECT_CALL(sdbusMock, sd_bus_emit_object_added(_, StrEq(objPath)))
         .Times(2);
 
-    // On PSU inserted, it shall check if it's the latest version
-    std::set<std::string> expectedVersions = {version};
-    EXPECT_CALL(mockedUtils, getLatestVersion(ContainerEq(expectedVersions)))
-        .WillOnce(Return(version));
-    EXPECT_CALL(mockedUtils, isAssociated(StrEq(psuPath), _))
-        .WillOnce(Return(true));
+    // On PSU inserted, there is no stored image to compare its version with
+    EXPECT_CALL(mockedUtils, getLatestVersion(_)).Times(0);
     EXPECT_CALL(sdbusMock, sd_bus_message_new_method_call(_, _, _, _, _,
                                                           StrEq("StartUnit")))
         .Times(0);
@@ -365,6 +621,35 @@ TEST_F(TestItemUpdater, OnOnePSURemovedAndAddedWithLatestVersion)
         .Times(1);
 }
 
+TEST_F(TestItemUpdater, OnOnePSUSwappedWithinSettleWindow)
+{
+    constexpr auto psuPath = "/com/example/inventory/psu0";
+    constexpr auto version = "version0";
+    constexpr auto newVersion = "version1";
+    std::string objPath = getObjPath(version);
+    std::string newObjPath = getObjPath(newVersion);
+    ON_CALL(mockedUtils, getPSUInventoryPaths(_))
+        .WillByDefault(Return(std::vector<std::string>({psuPath})));
+    ON_CALL(mockedUtils, getModel(StrEq(psuPath)))
+        .WillByDefault(Return(std::string("dummyModel")));
+    EXPECT_CALL(mockedUtils, getVersion(StrEq(psuPath)))
+        .WillOnce(Return(std::string(version)))
+        .WillOnce(Return(std::string(newVersion)));
+    itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
+
+    // The PSU is replaced by one running another version. The removal and
+    // the insertion are coalesced by the settle window, so the PSU is only
+    // seen present, while still associated with the version it replaced.
+    GetPsuCache()->setPresent(psuPath, false);
+    GetPsuCache()->setPresent(psuPath, true);
+    EXPECT_CALL(sdbusMock, sd_bus_emit_object_removed(_, StrEq(objPath)))
+        .Times(2);
+    EXPECT_CALL(sdbusMock, sd_bus_emit_object_added(_, StrEq(newObjPath)))
+        .Times(2);
+    onPsuInventoryChanged(psuPath, propAdded);
+    EXPECT_TRUE(GetActivation(newVersion)->isAssociated(psuPath));
+}
+
 TEST_F(TestItemUpdater,
        TwoPSUsWithSameVersionRemovedAndAddedWithDifferntVersion)
 {
@@ -407,9 +692,9 @@ TEST_F(TestItemUpdater,
     itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
 
     // Verify there is only one activation and it has two associations
-    const auto& activations = GetActivations();
-    EXPECT_EQ(1U, activations.size());
-    const auto& activation = activations.find(version0)->second;
+    const auto& software = GetSoftware();
+    EXPECT_EQ(1U, software.size());
+    const auto& activation = GetActivation(version0);
     auto assocs = activation->associations();
     EXPECT_EQ(2U, assocs.size());
     EXPECT_EQ(psu0, std::get<2>(assocs[0]));
@@ -568,37 +853,28 @@ TEST_F(TestItemUpdater, OnUpdateDoneOnTwoPSUsWithSameVersion)
 
     itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
 
-    std::string newVersionId = "NewVersionId";
-    AssociationList associations;
-    auto dummyActivation = std::make_unique<Activation>(
-        mockedBus, dBusPath, newVersionId, "", Activation::Status::Active,
-        associations, "", itemUpdater.get(), itemUpdater.get());
+    auto newHandle = createSoftware("NewVersion", "");
 
     // Now there is one activation and it has two associations
-    auto& activations = GetActivations();
-    activations.emplace(newVersionId, std::move(dummyActivation));
-    auto& activation = activations.find(version0)->second;
+    auto& software = GetSoftware();
+    auto& activation = GetActivation(version0);
     auto assocs = activation->associations();
     EXPECT_EQ(2U, assocs.size());
     EXPECT_EQ(psu0, std::get<2>(assocs[0]));
     EXPECT_EQ(psu1, std::get<2>(assocs[1]));
 
-    EXPECT_CALL(mockedUtils, isAssociated(StrEq(psu0), _))
-        .WillOnce(Return(true));
-    itemUpdater->onUpdateDone(newVersionId, psu0);
+    itemUpdater->onUpdateDone(newHandle, psu0);
 
     // Now the activation should have one association
     assocs = activation->associations();
     EXPECT_EQ(1U, assocs.size());
     EXPECT_EQ(psu1, std::get<2>(assocs[0]));
 
-    EXPECT_CALL(mockedUtils, isAssociated(StrEq(psu1), _))
-        .WillOnce(Return(true));
-    itemUpdater->onUpdateDone(newVersionId, psu1);
+    itemUpdater->onUpdateDone(newHandle, psu1);
 
     // Now the activation shall be erased and only the dummy one is left
-    EXPECT_EQ(1U, activations.size());
-    EXPECT_NE(activations.find(newVersionId), activations.end());
+    EXPECT_EQ(1U, software.size());
+    EXPECT_TRUE(software.contains(newHandle));
 }
 
 TEST_F(TestItemUpdater, OnUpdateDoneOnTwoPSUsWithDifferentVersion)
@@ -636,32 +912,21 @@ TEST_F(TestItemUpdater, OnUpdateDoneOnTwoPSUsWithDifferentVersion)
 
     itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
 
-    std::string newVersionId = "NewVersionId";
-    AssociationList associations;
-    auto dummyActivation = std::make_unique<Activation>(
-        mockedBus, dBusPath, newVersionId, "", Activation::Status::Active,
-        associations, "", itemUpdater.get(), itemUpdater.get());
-
-    auto& activations = GetActivations();
-    activations.emplace(newVersionId, std::move(dummyActivation));
-
-    EXPECT_CALL(mockedUtils, isAssociated(StrEq(psu0), _))
-        .WillOnce(Return(true));
+    auto newHandle = createSoftware("NewVersion", "");
+    auto& software = GetSoftware();
 
     // After psu0 is done, two activations should be left
-    itemUpdater->onUpdateDone(newVersionId, psu0);
-    EXPECT_EQ(2U, activations.size());
-    const auto& activation1 = activations.find(version1)->second;
+    itemUpdater->onUpdateDone(newHandle, psu0);
+    EXPECT_EQ(2U, software.size());
+    const auto& activation1 = GetActivation(version1);
     const auto& assocs1 = activation1->associations();
     EXPECT_EQ(1U, assocs1.size());
     EXPECT_EQ(psu1, std::get<2>(assocs1[0]));
 
-    EXPECT_CALL(mockedUtils, isAssociated(StrEq(psu1), _))
-        .WillOnce(Return(true));
     // After psu1 is done, only the dummy activation should be left
-    itemUpdater->onUpdateDone(newVersionId, psu1);
-    EXPECT_EQ(1U, activations.size());
-    EXPECT_NE(activations.find(newVersionId), activations.end());
+    itemUpdater->onUpdateDone(newHandle, psu1);
+    EXPECT_EQ(1U, software.size());
+    EXPECT_TRUE(software.contains(newHandle));
 }
 
 TEST_F(TestItemUpdater, OnOnePSURemovedAndAddedWithOldVersion)
@@ -669,8 +934,6 @@ TEST_F(TestItemUpdater, OnOnePSURemovedAndAddedWithOldVersion)
     constexpr auto psuPath = "/com/example/inventory/psu0";
     constexpr auto service = "com.example.Software.Psu";
     constexpr auto version = "version0";
-    std::string versionId =
-        version; // In testing versionId is the same as version
     std::string objPath = getObjPath(version);
     ON_CALL(mockedUtils, getPSUInventoryPaths(_))
         .WillByDefault(Return(std::vector<std::string>({psuPath})));
@@ -687,25 +950,26 @@ TEST_F(TestItemUpdater, OnOnePSURemovedAndAddedWithOldVersion)
 
     itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
 
-    // Add an association to simulate that it has image in BMC filesystem
-    auto& activation = GetActivations().find(versionId)->second;
-    auto assocs = activation->associations();
-    assocs.emplace_back(ACTIVATION_FWD_ASSOCIATION, ACTIVATION_REV_ASSOCIATION,
-                        "SomePath");
-    activation->associations(assocs);
+    // Simulate that the version has an image in BMC filesystem
+    const auto& activation = GetActivation(version);
     activation->path("SomeFilePath");
 
+    // The activation of the stored image is kept once the PSU is removed
+    EXPECT_CALL(sdbusMock, sd_bus_emit_object_removed(_, StrEq(objPath)))
+        .Times(0);
     onPsuInventoryChanged(psuPath, propRemoved);
+    EXPECT_EQ(Activation::Status::Ready, activation->activation());
+    EXPECT_TRUE(activation->associations().empty());
 
-    // On PSU inserted, it checks and finds a newer version
+    // On PSU inserted, it checks and finds a newer version. The present
+    // state is cached, so only the manufacturer is read from D-Bus.
     auto oldVersion = "old-version";
     EXPECT_CALL(mockedUtils, getService(_, StrEq(psuPath), _))
-        .WillOnce(Return(service))
         .WillOnce(Return(service));
     EXPECT_CALL(mockedUtils,
                 getPropertyImpl(_, StrEq(service), StrEq(psuPath), _,
                                 StrEq(PRESENT)))
-        .WillOnce(Return(any(PropertyType(true)))); // present
+        .Times(0);
     EXPECT_CALL(mockedUtils, getVersion(StrEq(psuPath)))
         .WillOnce(Return(std::string(oldVersion)));
     EXPECT_CALL(mockedUtils, getPropertyImpl(_, StrEq(service), StrEq(psuPath),
@@ -718,11 +982,51 @@ TEST_F(TestItemUpdater, OnOnePSURemovedAndAddedWithOldVersion)
     std::set<std::string> expectedVersions = {version, oldVersion};
     EXPECT_CALL(mockedUtils, getLatestVersion(ContainerEq(expectedVersions)))
         .WillOnce(Return(version));
-    ON_CALL(mockedUtils, isAssociated(StrEq(psuPath), _))
-        .WillByDefault(Return(false));
     EXPECT_CALL(sdbusMock, sd_bus_message_new_method_call(_, _, _, _, _,
                                                           StrEq("StartUnit")))
         .Times(3); // There are 3 systemd units are started, enable bmc reboot
                    // guard, start activation, and disable bmc reboot guard
     onPsuInventoryChanged(psuPath, propAdded);
 }
+
+TEST_F(TestItemUpdater, OnOnePSURemovedAndAddedWithStoredVersion)
+{
+    constexpr auto psuPath = "/com/example/inventory/psu0";
+    constexpr auto version = "version0";
+    constexpr auto assocIface = "xyz.openbmc_project.Association.Definitions";
+    std::string objPath = getObjPath(version);
+    ON_CALL(mockedUtils, getPSUInventoryPaths(_))
+        .WillByDefault(Return(std::vector<std::string>({psuPath})));
+    ON_CALL(mockedUtils, getVersion(StrEq(psuPath)))
+        .WillByDefault(Return(std::string(version)));
+    ON_CALL(mockedUtils, getModel(StrEq(psuPath)))
+        .WillByDefault(Return(std::string("dummyModel")));
+    itemUpdater = std::make_unique<ItemUpdater>(mockedBus, dBusPath);
+
+    // Simulate that the version has an image in BMC filesystem
+    const auto& activation = GetActivation(version);
+    activation->path("SomeFilePath");
+
+    // The removal of the PSU association is signalled, so that the mapper
+    // no longer associates the kept software with the removed PSU
+    EXPECT_CALL(sdbusMock, sd_bus_emit_object_removed(_, StrEq(objPath)))
+        .Times(0);
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               _, StrEq(objPath), StrEq(assocIface), _))
+        .Times(1);
+    onPsuInventoryChanged(psuPath, propRemoved);
+    EXPECT_EQ(Activation::Status::Ready, activation->activation());
+    EXPECT_TRUE(activation->associations().empty());
+    Mock::VerifyAndClearExpectations(&sdbusMock);
+
+    // The PSU plugged in again runs the stored image, so the activation is
+    // reused and no update is started
+    EXPECT_CALL(sdbusMock, sd_bus_emit_object_added(_, StrEq(objPath)))
+        .Times(0);
+    EXPECT_CALL(sdbusMock, sd_bus_message_new_method_call(_, _, _, _, _,
+                                                          StrEq("StartUnit")))
+        .Times(0);
+    onPsuInventoryChanged(psuPath, propAdded);
+    EXPECT_EQ(Activation::Status::Active, activation->activation());
+    EXPECT_TRUE(activation->isAssociated(psuPath));
+}
@@ -0,0 +1,61 @@
+#include "job_dispatcher.hpp"
+
+#include <sdbusplus/test/sdbus_mock.hpp>
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using ::testing::NiceMock;
+
+using utils::JobDispatcher;
+
+class TestJobDispatcher : public ::testing::Test
+{
+  public:
+    static constexpr auto unit0 = "psu-update@0.service";
+    static constexpr auto unit1 = "psu-update@1.service";
+
+    NiceMock<sdbusplus::SdBusMock> sdbusMock;
+    sdbusplus::bus_t mockedBus = sdbusplus::get_mocked_new(&sdbusMock);
+    JobDispatcher jobDispatcher{mockedBus};
+};
+
+TEST_F(TestJobDispatcher, dispatch)
+{
+    std::vector<std::string> results0;
+    std::vector<std::string> results1;
+    jobDispatcher.watch(unit0, [&results0](const std::string& result) {
+        results0.push_back(result);
+    });
+    jobDispatcher.watch(unit1, [&results1](const std::string& result) {
+        results1.push_back(result);
+    });
+    EXPECT_EQ(2U, jobDispatcher.watching());
+
+    jobDispatcher.dispatch(unit0, "canceled");
+    jobDispatcher.dispatch(unit0, "done");
+    jobDispatcher.dispatch("other.service", "done");
+    EXPECT_EQ((std::vector<std::string>{"canceled", "done"}), results0);
+    EXPECT_TRUE(results1.empty());
+
+    jobDispatcher.unwatch(unit0);
+    jobDispatcher.dispatch(unit0, "done");
+    EXPECT_EQ(2U, results0.size());
+    EXPECT_EQ(1U, jobDispatcher.watching());
+}
+
+TEST_F(TestJobDispatcher, unwatchFromCallback)
+{
+    int calls = 0;
+    jobDispatcher.watch(unit0, [this, &calls](const std::string&) {
+        ++calls;
+        jobDispatcher.unwatch(unit0);
+    });
+    jobDispatcher.dispatch(unit0, "done");
+    jobDispatcher.dispatch(unit0, "done");
+    EXPECT_EQ(1, calls);
+    EXPECT_EQ(0U, jobDispatcher.watching());
+}
@@ -0,0 +1,187 @@
+#include "config.h"
+
+#include "mocked_utils.hpp"
+#include "psu_cache.hpp"
+
+#include <sdbusplus/test/sdbus_mock.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace phosphor::software::updater;
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::StrEq;
+
+using std::any;
+
+class TestPsuCache : public ::testing::Test
+{
+  public:
+    using PropertyType = utils::UtilsInterface::PropertyType;
+
+    TestPsuCache(const TestPsuCache&) = delete;
+    TestPsuCache& operator=(const TestPsuCache&) = delete;
+    TestPsuCache(TestPsuCache&&) = delete;
+    TestPsuCache& operator=(TestPsuCache&&) = delete;
+
+    TestPsuCache() :
+        mockedUtils(
+            reinterpret_cast<const utils::MockedUtils&>(utils::getUtils()))
+    {
+        ON_CALL(mockedUtils, getPropertyImpl(_, _, _, _, StrEq(PRESENT)))
+            .WillByDefault(Return(any(PropertyType(true))));
+        ON_CALL(mockedUtils, getPropertyImpl(_, _, _, _, StrEq(MANUFACTURER)))
+            .WillByDefault(Return(any(PropertyType(std::string("TestManu")))));
+        ON_CALL(mockedUtils, getModel(_))
+            .WillByDefault(Return(std::string("TestModel")));
+    }
+
+    ~TestPsuCache() override
+    {
+        utils::freeUtils();
+    }
+
+    static constexpr auto psu0 = "/com/example/inventory/psu0";
+    static constexpr auto psu1 = "/com/example/inventory/psu1";
+    NiceMock<sdbusplus::SdBusMock> sdbusMock;
+    sdbusplus::bus_t mockedBus = sdbusplus::get_mocked_new(&sdbusMock);
+    const utils::MockedUtils& mockedUtils;
+    PsuCache psuCache{mockedBus};
+};
+
+TEST_F(TestPsuCache, untrackedPSUsAreNotCached)
+{
+    EXPECT_CALL(mockedUtils, getPropertyImpl(_, _, StrEq(psu0), _, _))
+        .Times(4);
+    EXPECT_CALL(mockedUtils, getModel(StrEq(psu0))).Times(2);
+
+    EXPECT_TRUE(psuCache.isPresent(psu0));
+    EXPECT_TRUE(psuCache.isPresent(psu0));
+    EXPECT_EQ("TestManu", psuCache.getManufacturer(psu0));
+    EXPECT_EQ("TestManu", psuCache.getManufacturer(psu0));
+    EXPECT_EQ("TestModel", psuCache.getModels({psu0})[psu0]);
+    EXPECT_EQ("TestModel", psuCache.getModels({psu0})[psu0]);
+    EXPECT_EQ(nullptr, psuCache.find(psu0));
+    EXPECT_EQ(0U, psuCache.hits());
+    EXPECT_EQ(6U, psuCache.misses());
+}
+
+TEST_F(TestPsuCache, trackedPSUsAreCached)
+{
+    psuCache.track(psu0);
+    psuCache.track(psu1);
+    psuCache.setPresent(psu0, true);
+    psuCache.setPresent(psu1, true);
+    psuCache.setProbed(psu0, "Model0", "Version0");
+
+    // Only the model of psu1 is queried
+    EXPECT_CALL(mockedUtils, getPropertyImpl(_, _, _, _, StrEq(PRESENT)))
+        .Times(0);
+    EXPECT_CALL(mockedUtils, getModel(StrEq(psu0))).Times(0);
+    EXPECT_CALL(mockedUtils, getModel(StrEq(psu1)))
+        .WillOnce(Return(std::string("Model1")));
+    EXPECT_TRUE(psuCache.isPresent(psu0));
+    auto models = psuCache.getModels({psu0, psu1});
+    EXPECT_EQ("Model0", models[psu0]);
+    EXPECT_EQ("Model1", models[psu1]);
+    models = psuCache.getModels({psu0, psu1});
+    EXPECT_EQ("Model1", models[psu1]);
+    EXPECT_EQ("Version0", psuCache.getVersion(psu0));
+    EXPECT_FALSE(psuCache.getVersion(psu1));
+
+    EXPECT_EQ(5U, psuCache.hits());
+    EXPECT_EQ(2U, psuCache.misses());
+}
+
+TEST_F(TestPsuCache, invalidateOnPresenceChange)
+{
+    psuCache.track(psu0);
+    psuCache.setPresent(psu0, true);
+    psuCache.setProbed(psu0, "Model0", "Version0");
+    EXPECT_CALL(mockedUtils, getPropertyImpl(_, _, _, _, StrEq(MANUFACTURER)))
+        .Times(1);
+    EXPECT_EQ("TestManu", psuCache.getManufacturer(psu0));
+    EXPECT_EQ("TestManu", psuCache.getManufacturer(psu0));
+
+    // Setting the same state keeps the attributes
+    psuCache.setPresent(psu0, true);
+    EXPECT_EQ("Model0", psuCache.getModel(psu0));
+
+    // The PSU is replaced
+    psuCache.setPresent(psu0, false);
+    EXPECT_FALSE(psuCache.isPresent(psu0));
+    EXPECT_FALSE(psuCache.getModel(psu0));
+    psuCache.setProbed(psu0, "Model0", "Version0");
+    EXPECT_FALSE(psuCache.getModel(psu0));
+
+    psuCache.setPresent(psu0, true);
+    EXPECT_FALSE(psuCache.getModel(psu0));
+    EXPECT_FALSE(psuCache.getVersion(psu0));
+}
+
+TEST_F(TestPsuCache, setInventory)
+{
+    psuCache.track(psu0);
+    psuCache.track(psu1);
+
+    utils::PsuInventory psu;
+    psu.present = true;
+    psu.manufacturer = "SnapshotManu";
+    psuCache.setInventory(psu0, psu);
+    psuCache.setInventory(psu1, utils::PsuInventory{});
+
+    EXPECT_CALL(mockedUtils, getPropertyImpl(_, _, StrEq(psu0), _, _))
+        .Times(0);
+    EXPECT_TRUE(psuCache.isPresent(psu0));
+    EXPECT_EQ("SnapshotManu", psuCache.getManufacturer(psu0));
+
+    // The manufacturer of a missing PSU is not cached
+    psu.present = false;
+    psuCache.setInventory(psu0, psu);
+    EXPECT_FALSE(psuCache.isPresent(psu0));
+    EXPECT_FALSE(psuCache.find(psu0)->manufacturer);
+
+    // Unknown properties are left as-is
+    EXPECT_FALSE(psuCache.find(psu1)->present);
+    EXPECT_FALSE(psuCache.find(psu1)->manufacturer);
+}
+
+TEST_F(TestPsuCache, untrack)
+{
+    psuCache.track(psu0);
+    psuCache.setPresent(psu0, true);
+    psuCache.setProbed(psu0, "Model0", "Version0");
+    EXPECT_FALSE(psuCache.seeded());
+    psuCache.markSeeded();
+    EXPECT_TRUE(psuCache.seeded());
+
+    psuCache.untrack(psu0);
+    EXPECT_EQ(nullptr, psuCache.find(psu0));
+    EXPECT_TRUE(psuCache.entries().empty());
+    EXPECT_FALSE(psuCache.getModel(psu0));
+}
+
+TEST_F(TestPsuCache, invalidate)
+{
+    psuCache.track(psu0);
+    psuCache.setPresent(psu0, true);
+    psuCache.setProbed(psu0, "Model0", "Version0");
+
+    psuCache.invalidate(psu0);
+    EXPECT_TRUE(psuCache.isPresent(psu0));
+    EXPECT_FALSE(psuCache.getModel(psu0));
+    EXPECT_FALSE(psuCache.getVersion(psu0));
+
+    psuCache.setProbed(psu0, "Model0", "Version0");
+    psuCache.invalidate();
+    EXPECT_TRUE(psuCache.isPresent(psu0));
+    EXPECT_FALSE(psuCache.getModel(psu0));
+
+    // Failures to get the values are not cached
+    psuCache.setProbed(psu0, "", "");
+    EXPECT_FALSE(psuCache.getModel(psu0));
+    EXPECT_FALSE(psuCache.getVersion(psu0));
+}
@@ -0,0 +1,78 @@
+#include "service_cache.hpp"
+
+#include <sdbusplus/test/sdbus_mock.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using ::testing::NiceMock;
+
+using utils::ServiceCache;
+
+class TestServiceCache : public ::testing::Test
+{
+  public:
+    static constexpr auto base = "/com/example/inventory";
+    static constexpr auto psu0 = "/com/example/inventory/psu0";
+    static constexpr auto psu1 = "/com/example/inventory/psu1";
+    static constexpr auto itemIface = "xyz.openbmc_project.Inventory.Item";
+    static constexpr auto assetIface =
+        "xyz.openbmc_project.Inventory.Decorator.Asset";
+    static constexpr auto inventory = "xyz.openbmc_project.Inventory.Manager";
+
+    NiceMock<sdbusplus::SdBusMock> sdbusMock;
+    sdbusplus::bus_t mockedBus = sdbusplus::get_mocked_new(&sdbusMock);
+    ServiceCache serviceCache;
+};
+
+TEST_F(TestServiceCache, disabledUntilWatched)
+{
+    serviceCache.insert(psu0, itemIface, {inventory});
+    EXPECT_FALSE(serviceCache.find(psu0, itemIface));
+    EXPECT_EQ(0U, serviceCache.misses());
+
+    serviceCache.watch(mockedBus, base);
+    EXPECT_FALSE(serviceCache.find(psu0, itemIface));
+    serviceCache.insert(psu0, itemIface, {inventory});
+    EXPECT_EQ(ServiceCache::Services{inventory},
+              serviceCache.find(psu0, itemIface));
+    EXPECT_EQ(1U, serviceCache.hits());
+    EXPECT_EQ(1U, serviceCache.misses());
+
+    // Empty lists are not cached
+    serviceCache.insert(psu1, itemIface, {});
+    EXPECT_FALSE(serviceCache.find(psu1, itemIface));
+
+    // Nor are the objects outside of the watched namespace
+    serviceCache.insert(base, itemIface, {inventory});
+    EXPECT_FALSE(serviceCache.find(base, itemIface));
+    serviceCache.insert("/com/example/other", itemIface, {inventory});
+    EXPECT_FALSE(serviceCache.find("/com/example/other", itemIface));
+}
+
+TEST_F(TestServiceCache, invalidate)
+{
+    serviceCache.watch(mockedBus, base);
+    serviceCache.insert(psu0, itemIface, {inventory});
+    serviceCache.insert(psu0, assetIface, {inventory});
+    serviceCache.insert(psu1, itemIface, {"com.example.Other", inventory});
+    serviceCache.insert(psu1, assetIface, {"com.example.Other"});
+
+    serviceCache.removeInterfaces(psu0, {assetIface});
+    EXPECT_TRUE(serviceCache.find(psu0, itemIface));
+    EXPECT_FALSE(serviceCache.find(psu0, assetIface));
+
+    // All entries that contain the service are invalidated
+    serviceCache.removeService(inventory);
+    EXPECT_FALSE(serviceCache.find(psu0, itemIface));
+    EXPECT_FALSE(serviceCache.find(psu1, itemIface));
+    EXPECT_TRUE(serviceCache.find(psu1, assetIface));
+
+    serviceCache.insert(psu0, itemIface, {inventory});
+    serviceCache.removeObject(psu1);
+    EXPECT_FALSE(serviceCache.find(psu1, assetIface));
+    EXPECT_TRUE(serviceCache.find(psu0, itemIface));
+
+    serviceCache.clear();
+    EXPECT_FALSE(serviceCache.find(psu0, itemIface));
+}
@@ -0,0 +1,56 @@
+#include "slot_map.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using utils::SlotHandle;
+using utils::SlotMap;
+
+TEST(SlotMap, detectsStaleHandles)
+{
+    SlotMap<std::string> map;
+    EXPECT_EQ(nullptr, map.find(SlotHandle{}));
+
+    auto a = map.insert("a");
+    auto b = map.insert("b");
+    EXPECT_EQ(2U, map.size());
+    EXPECT_EQ("a", *map.find(a));
+    EXPECT_EQ("b", *map.find(b));
+
+    EXPECT_TRUE(map.erase(a));
+    EXPECT_FALSE(map.erase(a));
+    EXPECT_FALSE(map.contains(a));
+
+    // The slot is reused, but the old handle does not refer to the new record
+    auto c = map.insert("c");
+    EXPECT_EQ(a.index, c.index);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(nullptr, map.find(a));
+    EXPECT_EQ("c", *map.find(c));
+
+    std::vector<std::string> values;
+    map.forEach([&](SlotHandle handle, const std::string& value) {
+        EXPECT_TRUE(map.contains(handle));
+        values.push_back(value);
+    });
+    EXPECT_EQ((std::vector<std::string>{"c", "b"}), values);
+}
+
+TEST(SlotMap, insertsWithOwnHandle)
+{
+    SlotMap<SlotHandle> map;
+    auto handle = map.insertWith([](SlotHandle self) { return self; });
+    EXPECT_EQ(handle, *map.find(handle));
+
+    // Nothing is inserted if the record cannot be built
+    auto fail = [](SlotHandle) -> SlotHandle {
+        throw std::runtime_error("failed");
+    };
+    EXPECT_THROW(map.insertWith(fail), std::runtime_error);
+    EXPECT_EQ(1U, map.size());
+    auto other = map.insertWith([](SlotHandle self) { return self; });
+    EXPECT_EQ(handle.index + 1, other.index);
+}
@@ -1,9 +1,22 @@
 #include "config.h"
 
+#include "debouncer.hpp"
+#include "helper.hpp"
+#include "plugin.hpp"
+#include "subprocess.hpp"
 #include "utils.hpp"
 
 #include <sdbusplus/test/sdbus_mock.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <tuple>
+#include <vector>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -14,6 +27,8 @@ using ::testing::NiceMock;
 using ::testing::Return;
 using ::testing::StrEq;
 
+namespace fs = std::filesystem;
+
 TEST(Utils, GetPSUInventoryPath)
 {
     NiceMock<sdbusplus::SdBusMock> sdbusMock;
@@ -67,22 +82,362 @@ TEST(Utils, GetPSUInventoryPath)
 TEST(Utils, GetVersionID)
 {
     auto ret = utils::getVersionId("");
-    EXPECT_EQ("", ret);
+    EXPECT_FALSE(ret);
 
     ret = utils::getVersionId("some version");
-    EXPECT_EQ(8U, ret.size());
+    ASSERT_TRUE(ret);
+    EXPECT_EQ(8U, ret->str().size());
+    EXPECT_EQ(ret, utils::VersionId::parse(ret->str()));
+}
+
+TEST(Utils, SplitCommand)
+{
+    auto argv = utils::splitCommand("  /usr/bin/psutils --raw\t--get-version ");
+    ASSERT_EQ(3U, argv.size());
+    EXPECT_EQ("/usr/bin/psutils", argv[0]);
+    EXPECT_EQ("--raw", argv[1]);
+    EXPECT_EQ("--get-version", argv[2]);
+
+    EXPECT_TRUE(utils::splitCommand("").empty());
+}
+
+TEST(Utils, SubprocessRun)
+{
+    // Arguments are passed as-is without a shell
+    auto [rc, output] = utils::Subprocess::run({"echo", "$HOME", "a;b"});
+    EXPECT_EQ(0, rc);
+    EXPECT_EQ("$HOME a;b\n", output);
+
+    rc = utils::Subprocess::run({"false"}).first;
+    EXPECT_NE(0, rc);
+
+    EXPECT_THROW(utils::Subprocess::run({"/path/does/not/exist"}),
+                 std::runtime_error);
+}
+
+TEST(Utils, SubprocessLimits)
+{
+    using namespace std::chrono_literals;
+    utils::ExecLimits limits;
+    limits.timeout = 100ms;
+    limits.killDelay = 100ms;
+
+    auto count = utils::Subprocess::timeoutCount("sleep");
+    auto [rc, output] = utils::Subprocess::run({"sleep", "10"}, limits);
+    EXPECT_EQ(utils::Subprocess::limitExceeded, rc);
+    EXPECT_EQ(count + 1, utils::Subprocess::timeoutCount("sleep"));
+
+    // SIGKILL is sent if the command ignores SIGTERM
+    auto start = std::chrono::steady_clock::now();
+    rc = utils::Subprocess::run(
+             {"sh", "-c", "trap '' TERM; exec sleep 10"}, limits)
+             .first;
+    EXPECT_EQ(utils::Subprocess::limitExceeded, rc);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+
+    // The timeout still applies once the command has closed its stdout
+    start = std::chrono::steady_clock::now();
+    rc = utils::Subprocess::run({"sh", "-c", "exec >&-; exec sleep 10"}, limits)
+             .first;
+    EXPECT_EQ(utils::Subprocess::limitExceeded, rc);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+
+    limits.timeout = 0ms;
+    limits.maxOutput = 10;
+    std::tie(rc, output) = utils::Subprocess::run({"yes"}, limits);
+    EXPECT_EQ(utils::Subprocess::limitExceeded, rc);
+    EXPECT_EQ(10U, output.size());
+}
+
+TEST(Utils, SubprocessStartLimits)
+{
+    using namespace std::chrono_literals;
+    utils::ExecLimits limits;
+    limits.timeout = 100ms;
+    limits.killDelay = 100ms;
+
+    sd_event* event = nullptr;
+    ASSERT_GE(sd_event_new(&event), 0);
+    int status = 0;
+    utils::Subprocess::start(
+        event, {"sh", "-c", "trap '' TERM; exec sleep 10"},
+        [&](int rc, std::string) {
+            status = rc;
+            sd_event_exit(event, 0);
+        },
+        limits);
+    sd_event_loop(event);
+    EXPECT_EQ(utils::Subprocess::limitExceeded, status);
+    sd_event_unref(event);
+}
+
+TEST(Utils, Debouncer)
+{
+    using namespace std::chrono_literals;
+    sd_event* event = nullptr;
+    ASSERT_GE(sd_event_new(&event), 0);
+    {
+        int count = 0;
+        utils::Debouncer debouncer(event, 50ms, [&]() {
+            ++count;
+            sd_event_exit(event, 0);
+        });
+
+        // A burst of events is handled once
+        debouncer.schedule();
+        debouncer.schedule();
+        debouncer.schedule();
+        EXPECT_TRUE(debouncer.pending());
+        EXPECT_EQ(0, count);
+        sd_event_loop(event);
+        EXPECT_EQ(1, count);
+        EXPECT_FALSE(debouncer.pending());
+
+        debouncer.schedule();
+        debouncer.flush();
+        EXPECT_EQ(2, count);
+        debouncer.flush();
+        EXPECT_EQ(2, count);
+    }
+    sd_event_unref(event);
+
+    // Without an event loop the callback is invoked immediately
+    int count = 0;
+    utils::Debouncer debouncer(nullptr, 50ms, [&count]() { ++count; });
+    debouncer.schedule();
+    debouncer.schedule();
+    EXPECT_EQ(2, count);
+    EXPECT_FALSE(debouncer.pending());
+}
+
+TEST(Utils, ParseBatchOutput)
+{
+    constexpr auto psu0 = "/xyz/openbmc_project/inventory/psu0";
+    constexpr auto psu1 = "/xyz/openbmc_project/inventory/psu1";
+    auto values = utils::parseBatchOutput(
+        "/xyz/openbmc_project/inventory/psu0 0001\n"
+        "Usage: get_version <psu-inventory-path>\n"
+        "/xyz/openbmc_project/inventory/psu1 model with spaces");
+    ASSERT_EQ(2U, values.size());
+    EXPECT_EQ("0001", values[psu0]);
+    EXPECT_EQ("model with spaces", values[psu1]);
+
+    // Output of a tool that does not support the batch mode
+    EXPECT_TRUE(utils::parseBatchOutput("00000110").empty());
+    EXPECT_TRUE(utils::parseBatchOutput("").empty());
+}
+
+TEST(Utils, QueryBatchUnsupported)
+{
+    constexpr auto psu0 = "/xyz/openbmc_project/inventory/psu0";
+    constexpr auto psu1 = "/xyz/openbmc_project/inventory/psu1";
+    auto tmpDir = (fs::temp_directory_path() / "test_XXXXXX").string();
+    ASSERT_NE(nullptr, mkdtemp(tmpDir.data()));
+
+    // A legacy tool that rejects the batch arguments with a usage error, and
+    // logs its invocations
+    auto tool = fs::path(tmpDir) / "psutils";
+    auto calls = fs::path(tmpDir) / "calls";
+    {
+        std::ofstream file(tool);
+        file << "#!/bin/sh\necho \"$@\" >> " << calls.string()
+             << "\necho 'Usage: psutils <psu-inventory-path>' >&2\nexit 2\n";
+    }
+    fs::permissions(tool, fs::perms::owner_all);
+
+    int queries = 0;
+    auto query = [&queries](const std::string&) {
+        ++queries;
+        return std::string{"0001"};
+    };
+    auto values = utils::queryBatch(tool.string(), 5, {psu0, psu1}, query);
+    EXPECT_EQ(2U, values.size());
+    EXPECT_EQ("0001", values[psu0]);
+    EXPECT_EQ(2, queries);
+
+    // The batch mode is not tried again
+    values = utils::queryBatch(tool.string(), 5, {psu0, psu1}, query);
+    EXPECT_EQ(2U, values.size());
+    EXPECT_EQ(4, queries);
+    std::ifstream log(calls);
+    std::string content((std::istreambuf_iterator<char>(log)),
+                        std::istreambuf_iterator<char>());
+    EXPECT_EQ(std::string{"--batch "} + psu0 + " " + psu1 + "\n", content);
+
+    fs::remove_all(tmpDir);
 }
 
-TEST(Utils, IsAssociated)
+namespace
+{
+// A helper that answers each request with its first argument
+const std::vector<std::string> echoHelper = {
+    "sh", "-c",
+    "while read -r id op arg rest; do printf '%s\\t0\\t%s\\n' \"$id\" \"$arg\"; "
+    "done"};
+} // namespace
+
+TEST(Utils, HelperCall)
 {
-    std::string path = "/com/example/chassis/powersupply0";
-    utils::AssociationList assocs = {
-        {ACTIVATION_FWD_ASSOCIATION, ACTIVATION_REV_ASSOCIATION,
-         "a-different-path"}};
+    sd_event* event = nullptr;
+    ASSERT_GE(sd_event_new(&event), 0);
+    {
+        utils::Helper helper(event, echoHelper, std::chrono::seconds(5));
+        auto [status, value] = helper.call("get-version", {"/psu0"});
+        EXPECT_EQ(0, status);
+        EXPECT_EQ("/psu0", value);
 
-    EXPECT_FALSE(utils::isAssociated(path, assocs));
+        // Invalid arguments are not sent
+        EXPECT_EQ(utils::Helper::unavailable,
+                  helper.call("get-version", {"a\tb"}).first);
+    }
+    sd_event_unref(event);
+}
 
-    assocs.emplace_back(ACTIVATION_FWD_ASSOCIATION, ACTIVATION_REV_ASSOCIATION,
-                        path);
-    EXPECT_TRUE(utils::isAssociated(path, assocs));
+TEST(Utils, HelperRequest)
+{
+    sd_event* event = nullptr;
+    ASSERT_GE(sd_event_new(&event), 0);
+    {
+        // Several requests are outstanding at once
+        utils::Helper helper(event, echoHelper, std::chrono::seconds(5));
+        std::vector<std::string> values;
+        for (auto psu : {"/psu0", "/psu1", "/psu2"})
+        {
+            helper.request("get-model", {psu},
+                           [&](int status, std::string value) {
+                               EXPECT_EQ(0, status);
+                               values.push_back(std::move(value));
+                               if (values.size() == 3)
+                               {
+                                   sd_event_exit(event, 0);
+                               }
+                           });
+        }
+        sd_event_loop(event);
+        std::sort(values.begin(), values.end());
+        EXPECT_EQ((std::vector<std::string>{"/psu0", "/psu1", "/psu2"}),
+                  values);
+    }
+    sd_event_unref(event);
+}
+
+TEST(Utils, HelperRestart)
+{
+    sd_event* event = nullptr;
+    ASSERT_GE(sd_event_new(&event), 0);
+    {
+        // The helper exits after each response and is restarted
+        utils::Helper helper(
+            event,
+            {"sh", "-c",
+             "read -r id op arg; printf '%s\\t0\\t%s\\n' \"$id\" \"$arg\""},
+            std::chrono::seconds(5));
+        EXPECT_EQ("/psu0", helper.call("get-version", {"/psu0"}).second);
+        EXPECT_EQ("/psu1", helper.call("get-version", {"/psu1"}).second);
+
+        std::string value;
+        helper.request("get-version", {"/psu2"}, [&](int, std::string v) {
+            value = std::move(v);
+            sd_event_exit(event, 0);
+        });
+        sd_event_loop(event);
+        EXPECT_EQ("/psu2", value);
+    }
+    sd_event_unref(event);
+}
+
+TEST(Utils, HelperTimeout)
+{
+    sd_event* event = nullptr;
+    ASSERT_GE(sd_event_new(&event), 0);
+    {
+        utils::Helper helper(event, {"sleep", "10"},
+                             std::chrono::milliseconds(100));
+        EXPECT_EQ(utils::Helper::unavailable,
+                  helper.call("get-version", {"/psu0"}).first);
+
+        int status = 0;
+        helper.request("get-version", {"/psu0"}, [&](int s, std::string) {
+            status = s;
+            sd_event_exit(event, 0);
+        });
+        sd_event_loop(event);
+        EXPECT_EQ(utils::Helper::unavailable, status);
+    }
+    sd_event_unref(event);
+}
+
+TEST(Utils, ForEachAsync)
+{
+    std::vector<std::string> items{"/psu0", "/psu1", "/psu2", "/psu3",
+                                   "/psu4"};
+    std::vector<std::string> started;
+    std::vector<utils::DoneCallback> pending;
+    size_t maxInFlight = 0;
+    int doneCount = 0;
+    utils::forEachAsync(
+        items, 2,
+        [&](const std::string& item, utils::DoneCallback done) {
+            started.push_back(item);
+            pending.push_back(std::move(done));
+            maxInFlight = std::max(maxInFlight, pending.size());
+        },
+        [&doneCount]() { ++doneCount; });
+
+    // The tasks are started in order, with at most 2 in flight
+    while (!pending.empty())
+    {
+        EXPECT_EQ(0, doneCount);
+        auto done = std::move(pending.front());
+        pending.erase(pending.begin());
+        done();
+    }
+    EXPECT_EQ(items, started);
+    EXPECT_EQ(2U, maxInFlight);
+    EXPECT_EQ(1, doneCount);
+
+    // Tasks completing synchronously
+    started.clear();
+    utils::forEachAsync(
+        items, 2,
+        [&started](const std::string& item, utils::DoneCallback done) {
+            started.push_back(item);
+            done();
+        },
+        [&doneCount]() { ++doneCount; });
+    EXPECT_EQ(items, started);
+    EXPECT_EQ(2, doneCount);
+
+    // No items
+    utils::forEachAsync(
+        {}, 2, [](const std::string&, utils::DoneCallback) { FAIL(); },
+        [&doneCount]() { ++doneCount; });
+    EXPECT_EQ(3, doneCount);
+}
+
+TEST(Utils, PluginUtils)
+{
+    utils::PluginUtils plugin(EXAMPLE_PLUGIN);
+    EXPECT_EQ("rsupply0", plugin.getVersion("/powersupply0"));
+    EXPECT_EQ("/psu0000", plugin.getVersion("/psu0"));
+    EXPECT_EQ("dummy_model", plugin.getModel("/psu0"));
+    EXPECT_EQ("0003", plugin.getLatestVersion({"0001", "0003", "0002"}));
+
+    // A value that does not fit in the buffer is an error
+    EXPECT_EQ("", plugin.getLatestVersion({std::string(2048, '1')}));
+
+    auto models = plugin.getModels({"/psu0", "/psu1"});
+    EXPECT_EQ("dummy_model", models["/psu0"]);
+    EXPECT_EQ("dummy_model", models["/psu1"]);
+
+    std::string version;
+    plugin.getVersionAsync("/psu1",
+                           [&version](std::string v) { version = v; });
+    EXPECT_EQ("/psu1000", version);
+}
+
+TEST(Utils, PluginUtilsInvalid)
+{
+    EXPECT_THROW(utils::PluginUtils("/path/does/not/exist.so"),
+                 std::runtime_error);
 }
@@ -1,10 +1,15 @@
+#include "manifest.hpp"
 #include "version.hpp"
 
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <map>
+#include <string>
 
 #include <gtest/gtest.h>
 
+using phosphor::software::updater::Manifest;
 using phosphor::software::updater::Version;
 
 namespace fs = std::filesystem;
@@ -54,55 +59,59 @@ class TestVersion : public ::testing::Test
     std::string tmpDir;
 };
 
-TEST_F(TestVersion, getValuesFileNotExist)
+TEST_F(TestVersion, readManifestFileNotExist)
 {
-    auto ret = Version::getValues("NotExist.file", {""});
-    EXPECT_TRUE(ret.empty());
+    EXPECT_FALSE(Manifest::read("NotExist.file"));
+    EXPECT_FALSE(Manifest::read(""));
 }
 
-TEST_F(TestVersion, getValuesOK)
+TEST_F(TestVersion, readManifestOK)
 {
     auto manifestFilePath = fs::path(tmpDir) / "MANIFEST";
     writeFile(manifestFilePath, validManifest);
-    auto ret = Version::getValues(manifestFilePath.string(),
-                                  {"purpose", "version", "extended_version"});
-    EXPECT_EQ(3U, ret.size());
-    auto purpose = ret["purpose"];
-    auto version = ret["version"];
-    auto extVersion = ret["extended_version"];
+    auto ret = Manifest::read(manifestFilePath.string());
+    ASSERT_TRUE(ret);
 
     EXPECT_EQ("xyz.openbmc_project.Software.Version.VersionPurpose.PSU",
-              purpose);
-    EXPECT_EQ("psu-dummy-test.v0.1", version);
-    EXPECT_EQ("model=dummy_model,manufacturer=dummy_manufacturer", extVersion);
+              ret->purpose);
+    EXPECT_EQ("psu-dummy-test.v0.1", ret->version);
+    EXPECT_EQ("model=dummy_model,manufacturer=dummy_manufacturer",
+              ret->extendedVersion);
+    EXPECT_EQ("dummy_model", ret->model);
+    EXPECT_EQ("dummy_manufacturer", ret->manufacturer);
+    EXPECT_TRUE(ret->otherKeys.empty());
 }
 
-TEST_F(TestVersion, getExtVersionInfo)
+TEST_F(TestVersion, parseManifest)
 {
-    std::string extVersion = "";
-    auto ret = Version::getExtVersionInfo(extVersion);
-    EXPECT_TRUE(ret.empty());
-
-    extVersion = "manufacturer=TestManu,model=TestModel";
-    ret = Version::getExtVersionInfo(extVersion);
-    EXPECT_EQ(2U, ret.size());
-    EXPECT_EQ("TestManu", ret["manufacturer"]);
-    EXPECT_EQ("TestModel", ret["model"]);
+    // The first value of a key is kept, and the other keys are preserved
+    auto ret = Manifest::parse("version=v1\n"
+                               "no value\n"
+                               "KeyType=OpenBMC\n"
+                               "version=v2\n"
+                               "HashType=RSA-SHA256\n"
+                               "extended_version=model=m1,model=m2");
+    EXPECT_EQ("v1", ret.version);
+    EXPECT_EQ("", ret.purpose);
+    EXPECT_EQ("m1", ret.model);
+    EXPECT_EQ("", ret.manufacturer);
+    EXPECT_EQ((std::map<std::string, std::string, std::less<>>{
+                  {"HashType", "RSA-SHA256"}, {"KeyType", "OpenBMC"}}),
+              ret.otherKeys);
 }
 
-TEST_F(TestVersion, getValuesOKonCRLFFormat)
+TEST_F(TestVersion, readManifestOKonCRLFFormat)
 {
     auto manifestFilePath = fs::path(tmpDir) / "MANIFEST";
     writeFile(manifestFilePath, validManifestWithCRLF);
-    auto ret = Version::getValues(manifestFilePath.string(),
-                                  {"purpose", "version", "extended_version"});
-    EXPECT_EQ(3U, ret.size());
-    auto purpose = ret["purpose"];
-    auto version = ret["version"];
-    auto extVersion = ret["extended_version"];
+    auto ret = Manifest::read(manifestFilePath.string());
+    ASSERT_TRUE(ret);
 
     EXPECT_EQ("xyz.openbmc_project.Software.Version.VersionPurpose.PSU",
-              purpose);
-    EXPECT_EQ("psu-dummy-test.v0.1", version);
-    EXPECT_EQ("model=dummy_model,manufacturer=dummy_manufacturer", extVersion);
+              ret->purpose);
+    EXPECT_EQ("psu-dummy-test.v0.1", ret->version);
+    EXPECT_EQ("model=dummy_model,manufacturer=dummy_manufacturer",
+              ret->extendedVersion);
+    EXPECT_EQ("dummy_model", ret->model);
+    EXPECT_EQ("dummy_manufacturer", ret->manufacturer);
 }
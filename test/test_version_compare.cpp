@@ -0,0 +1,79 @@
+#include "version_compare.hpp"
+
+#include <map>
+#include <string>
+
+#include <gtest/gtest.h>
+
+using utils::VersionCompare;
+using utils::VersionScheme;
+
+TEST(VersionCompare, ToVersionScheme)
+{
+    EXPECT_EQ(VersionScheme::util, utils::toVersionScheme("util"));
+    EXPECT_EQ(VersionScheme::semver, utils::toVersionScheme("semver"));
+    EXPECT_FALSE(utils::toVersionScheme("unknown"));
+}
+
+TEST(VersionCompare, Numeric)
+{
+    VersionCompare compare(VersionScheme::numeric);
+    EXPECT_LT(compare.compare("1.9", "1.10"), 0);
+    EXPECT_GT(compare.compare("2.0", "1.99"), 0);
+    EXPECT_EQ(0, compare.compare("01.02", "1.2"));
+    EXPECT_LT(compare.compare("1.2", "1.2.1"), 0);
+    EXPECT_LT(compare.compare("v1a", "v1b"), 0);
+
+    // Versions that compare equal are still distinct
+    EXPECT_TRUE(compare("01.02", "1.2"));
+    EXPECT_FALSE(compare("1.2", "01.02"));
+}
+
+TEST(VersionCompare, SemVer)
+{
+    VersionCompare compare(VersionScheme::semver);
+    EXPECT_LT(compare.compare("1.2.3", "1.10.0"), 0);
+    EXPECT_LT(compare.compare("1.2.3-rc1", "1.2.3"), 0);
+    EXPECT_LT(compare.compare("1.2.3-alpha", "1.2.3-alpha.1"), 0);
+    EXPECT_LT(compare.compare("1.2.3-alpha.1", "1.2.3-alpha.beta"), 0);
+    EXPECT_LT(compare.compare("1.2.3-rc.2", "1.2.3-rc.10"), 0);
+    EXPECT_EQ(0, compare.compare("v1.2.3", "1.2.3+build5"));
+
+    // Invalid versions are older than any valid one
+    EXPECT_LT(compare.compare("1.2", "0.0.1"), 0);
+}
+
+TEST(VersionCompare, Hex)
+{
+    VersionCompare compare(VersionScheme::hex);
+    EXPECT_LT(compare.compare("0x0F", "0x10"), 0);
+    EXPECT_EQ(0, compare.compare("0x00ab", "AB"));
+    EXPECT_GT(compare.compare("100", "ff"), 0);
+    EXPECT_LT(compare.compare("xyz", "0"), 0);
+}
+
+TEST(VersionCompare, Regex)
+{
+    // The captured groups are compared in order: major, minor, then build
+    VersionCompare compare(VersionScheme::regex,
+                           R"(FW_(\d+)\.(\d+)_B(\d+))");
+    EXPECT_LT(compare.compare("FW_1.9_B3", "FW_1.10_B1"), 0);
+    EXPECT_GT(compare.compare("FW_2.0_B2", "FW_2.0_B1"), 0);
+    EXPECT_LT(compare.compare("unknown", "FW_0.0_B0"), 0);
+
+    EXPECT_THROW(VersionCompare(VersionScheme::regex, "("), std::regex_error);
+}
+
+TEST(VersionCompare, LatestInMap)
+{
+    std::map<std::string, std::string, VersionCompare> versions{
+        VersionCompare(VersionScheme::numeric)};
+    versions.emplace("1.10", "id2");
+    versions.emplace("1.9", "id1");
+    versions.emplace("1.100", "id3");
+    EXPECT_EQ("1.100", versions.rbegin()->first);
+
+    versions.erase("1.100");
+    EXPECT_EQ("1.10", versions.rbegin()->first);
+    EXPECT_EQ("id1", versions.find("1.9")->second);
+}
@@ -0,0 +1,57 @@
+#include "version_id.hpp"
+#include "version_id_cache.hpp"
+
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+#include <gtest/gtest.h>
+
+using utils::VersionId;
+using utils::VersionIdCache;
+
+TEST(VersionId, formatAndParse)
+{
+    EXPECT_EQ("00c0ffee", VersionId(0xc0ffee).str());
+    EXPECT_EQ("deadbeef", VersionId(0xdeadbeef).str());
+    EXPECT_EQ(VersionId(0xdeadbeef), VersionId::parse("deadbeef"));
+    EXPECT_EQ(VersionId(0xdeadbeef), VersionId::parse("DEADBEEF"));
+    EXPECT_EQ(VersionId(0), VersionId::parse("00000000"));
+
+    EXPECT_FALSE(VersionId::parse(""));
+    EXPECT_FALSE(VersionId::parse("c0ffee"));
+    EXPECT_FALSE(VersionId::parse("deadbeef0"));
+    EXPECT_FALSE(VersionId::parse("version0"));
+    EXPECT_FALSE(VersionId::parse("-0000001"));
+    EXPECT_FALSE(VersionId::parse("+0000001"));
+}
+
+TEST(VersionId, hash)
+{
+    std::unordered_set<VersionId> ids{VersionId(1), VersionId(2)};
+    EXPECT_TRUE(ids.contains(VersionId(1)));
+    EXPECT_FALSE(ids.contains(VersionId(3)));
+    EXPECT_LT(VersionId(1), VersionId(2));
+}
+
+TEST(VersionIdCache, memoizesVersions)
+{
+    VersionIdCache cache;
+    EXPECT_FALSE(cache.get(""));
+
+    // The first 8 hex digits of the SHA-512 of the version
+    std::string version = "01.02.03";
+    EXPECT_EQ(VersionId(0xf97d7e52), cache.get(version));
+    EXPECT_EQ(VersionId(0xf97d7e52), cache.get(std::string_view(version)));
+    EXPECT_EQ(1U, cache.misses());
+    EXPECT_EQ(1U, cache.hits());
+    EXPECT_EQ(cache.compute("01.02.04"), cache.get("01.02.04"));
+
+    // The cache is bounded
+    for (size_t i = 0; i < VersionIdCache::maxEntries; ++i)
+    {
+        cache.get(std::to_string(i));
+    }
+    EXPECT_LE(cache.size(), VersionIdCache::maxEntries);
+    EXPECT_EQ(VersionId(0xf97d7e52), cache.get(version));
+}
@@ -0,0 +1,108 @@
+#include "utils.hpp"
+#include "version_id_registry.hpp"
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using utils::VersionId;
+using utils::VersionIdRegistry;
+
+namespace
+{
+
+std::vector<std::string> makeVersions(size_t count)
+{
+    std::vector<std::string> versions;
+    versions.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        versions.push_back("version-" + std::to_string(i));
+    }
+    return versions;
+}
+
+void insertAll(VersionIdRegistry& registry,
+               const std::vector<std::string>& versions)
+{
+    for (const auto& version : versions)
+    {
+        auto id = registry.resolve(version);
+        ASSERT_TRUE(id);
+        ASSERT_TRUE(registry.insert(version, *id));
+    }
+}
+
+} // namespace
+
+TEST(VersionIdRegistry, resolvesCollisions)
+{
+    // The SHA-512 of both versions start with 6827669b
+    const std::string first = "version-2705";
+    const std::string second = "version-106076";
+    ASSERT_EQ(utils::getVersionId(first), utils::getVersionId(second));
+
+    VersionIdRegistry registry;
+    auto id = registry.resolve(first);
+    ASSERT_EQ(VersionId(0x6827669b), id);
+    EXPECT_TRUE(registry.insert(first, *id));
+    EXPECT_EQ(id, registry.resolve(first));
+
+    // The later version gets the next word of its digest
+    EXPECT_FALSE(registry.insert(second, *id));
+    auto alternate = registry.resolve(second);
+    EXPECT_EQ(VersionId(0x704a6a35), alternate);
+    EXPECT_EQ(utils::getAlternateVersionId(second, 1), alternate);
+    EXPECT_TRUE(registry.insert(second, *alternate));
+    EXPECT_EQ(first, *registry.findVersion(*id));
+    EXPECT_EQ(second, *registry.findVersion(*alternate));
+
+    // The ids stay assigned until they are erased
+    registry.erase(*id);
+    EXPECT_FALSE(registry.find(first));
+    EXPECT_EQ(alternate, registry.resolve(second));
+    EXPECT_EQ(id, registry.resolve(first));
+}
+
+TEST(VersionIdRegistry, resolvesInOrder)
+{
+    const std::string first = "version-2705";
+    const std::string second = "version-106076";
+
+    // The usual id goes to the version resolved first, so the ids are only
+    // stable within one run
+    VersionIdRegistry registry;
+    auto id = registry.resolve(second);
+    ASSERT_EQ(utils::getVersionId(second), id);
+    EXPECT_TRUE(registry.insert(second, *id));
+    auto alternate = registry.resolve(first);
+    EXPECT_EQ(utils::getAlternateVersionId(first, 1), alternate);
+    EXPECT_TRUE(registry.insert(first, *alternate));
+
+    // It is not reassigned when the other version is resolved again
+    EXPECT_EQ(id, registry.resolve(second));
+    EXPECT_EQ(alternate, registry.resolve(first));
+}
+
+TEST(VersionIdRegistry, distinctIds)
+{
+    // Include the colliding version of version-2705
+    auto versions = makeVersions(5000);
+    versions.emplace_back("version-106076");
+    VersionIdRegistry registry;
+    insertAll(registry, versions);
+    ASSERT_EQ(versions.size(), registry.size());
+
+    std::unordered_set<VersionId> ids;
+    size_t alternates = 0;
+    for (const auto& version : versions)
+    {
+        auto id = registry.find(version);
+        ASSERT_TRUE(id);
+        EXPECT_TRUE(ids.insert(*id).second);
+        alternates += (id != utils::getVersionId(version));
+    }
+    EXPECT_EQ(1U, alternates);
+}
@@ -1,25 +1,40 @@
 #include <cstdio>
+#include <cstring>
 #include <string>
 
 // Get the version string for a PSU and output to stdout
 // In this example, it just returns the last 8 bytes as the version
 constexpr int NUM_OF_BYTES = 8;
 
+std::string getVersion(std::string psu)
+{
+    if (psu.size() < NUM_OF_BYTES)
+    {
+        psu.append(NUM_OF_BYTES - psu.size(), '0'); //"0", 8 - psu.size());
+    }
+    return psu.substr(psu.size() - NUM_OF_BYTES);
+}
+
 int main(int argc, char** argv)
 {
-    if (argc != 2)
+    // Batch mode: output "<psu-inventory-path> <version>" for each PSU
+    if (argc > 2 && strcmp(argv[1], "--batch") == 0)
     {
-        printf("Usage: %s <psu-inventory-path>\n", argv[0]);
-        return 1;
+        for (int i = 2; i < argc; ++i)
+        {
+            printf("%s %s\n", argv[i], getVersion(argv[i]).c_str());
+        }
+        return 0;
     }
 
-    std::string psu = argv[1];
-    if (psu.size() < NUM_OF_BYTES)
+    if (argc != 2)
     {
-        psu.append(NUM_OF_BYTES - psu.size(), '0'); //"0", 8 - psu.size());
+        printf("Usage: %s <psu-inventory-path>\n", argv[0]);
+        printf("       %s --batch <psu-inventory-path>...\n", argv[0]);
+        return 1;
     }
 
-    printf("%s", psu.substr(psu.size() - NUM_OF_BYTES).c_str());
+    printf("%s", getVersion(argv[1]).c_str());
 
     return 0;
 }
@@ -0,0 +1,72 @@
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// A PSU helper that keeps running and answers the requests read from stdin.
+// Each request is a line of tab-separated fields: <id> <op> <arg>...
+// and is answered with a line: <id> <status> <value>
+// In this example, the version is the last 8 bytes of the PSU inventory path
+// like get_version, the model is a fixed string, and the latest version is the
+// largest one like get_latest_version.
+constexpr int NUM_OF_BYTES = 8;
+
+std::string getVersion(std::string psu)
+{
+    if (psu.size() < NUM_OF_BYTES)
+    {
+        psu.append(NUM_OF_BYTES - psu.size(), '0');
+    }
+    return psu.substr(psu.size() - NUM_OF_BYTES);
+}
+
+int main()
+{
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+        std::vector<std::string> fields;
+        std::istringstream in(line);
+        for (std::string field; std::getline(in, field, '\t');)
+        {
+            fields.push_back(field);
+        }
+        if (fields.size() < 3)
+        {
+            continue;
+        }
+
+        const auto& id = fields[0];
+        const auto& op = fields[1];
+        int status = 0;
+        std::string value;
+        if (op == "get-version")
+        {
+            value = getVersion(fields[2]);
+        }
+        else if (op == "get-model")
+        {
+            value = "dummy_model";
+        }
+        else if (op == "compare")
+        {
+            for (size_t i = 2; i < fields.size(); ++i)
+            {
+                if (value < fields[i])
+                {
+                    value = fields[i];
+                }
+            }
+        }
+        else
+        {
+            status = 1;
+        }
+
+        // Flush each response as the updater waits for it
+        printf("%s\t%d\t%s\n", id.c_str(), status, value.c_str());
+        fflush(stdout);
+    }
+    return 0;
+}
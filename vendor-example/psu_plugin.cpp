@@ -0,0 +1,66 @@
+#include "psu_plugin.h"
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+// A PSU plugin that implements the same logic as get_version and
+// get_latest_version, and a fixed model string.
+constexpr size_t NUM_OF_BYTES = 8;
+
+namespace
+{
+
+int copy(const std::string& value, char* buf, size_t len)
+{
+    if (value.size() >= len)
+    {
+        return -ENOBUFS;
+    }
+    memcpy(buf, value.c_str(), value.size() + 1);
+    return 0;
+}
+
+int getVersion(const char* inventoryPath, char* buf, size_t len)
+{
+    std::string psu = inventoryPath;
+    if (psu.size() < NUM_OF_BYTES)
+    {
+        psu.append(NUM_OF_BYTES - psu.size(), '0');
+    }
+    return copy(psu.substr(psu.size() - NUM_OF_BYTES), buf, len);
+}
+
+int getModel(const char* /*inventoryPath*/, char* buf, size_t len)
+{
+    return copy("dummy_model", buf, len);
+}
+
+int compareVersions(const char* const* versions, size_t count, char* buf,
+                    size_t len)
+{
+    std::string latest;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (latest < versions[i])
+        {
+            latest = versions[i];
+        }
+    }
+    return copy(latest, buf, len);
+}
+
+const psu_plugin_ops ops = {
+    .abi_version = PSU_PLUGIN_ABI_VERSION,
+    .get_version = getVersion,
+    .get_model = getModel,
+    .compare_versions = compareVersions,
+    .update = nullptr,
+};
+
+} // namespace
+
+extern "C" const psu_plugin_ops* psu_plugin_get_ops()
+{
+    return &ops;
+}